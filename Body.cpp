@@ -26,37 +26,61 @@ void Body::step(const float dt) {
   // F = ma
   v_ += force_ * dt/mass_;
   x_ += v_ * dt;
+}
+
+void Body::sleep() {
+  asleep_ = true;
+  v_ = Vector2f::Zero();
+  sleep_force_ = force_;
+}
+
+void Body::wake() {
+  asleep_ = false;
+  still_frames_ = 0;
+}
+
+unsigned Body::update_stillness(const float max_speed) {
+  if (v_.squaredNorm() < max_speed * max_speed) {
+    ++still_frames_;
+  } else {
+    still_frames_ = 0;
+  }
+  return still_frames_;
+}
 
-  // Wall bouncing
-#ifdef WALL_BOUNCE
+void Body::bounce_off_walls(const Vector2f& box_size) {
   if (x_.x() < radius_) {
     v_.x() *= -1;
     x_.x() = radius_;
   }
-  if (x_.x() > SCREEN_WIDTH - radius_) {
+  if (x_.x() > box_size.x() - radius_) {
     v_.x() *= -1;
-    x_.x() = SCREEN_WIDTH - radius_;
+    x_.x() = box_size.x() - radius_;
   }
 
   if (x_.y() < radius_) {
     v_.y() *= -1;
     x_.y() = radius_;
   }
-  if (x_.y() > SCREEN_HEIGHT - radius_) {
+  if (x_.y() > box_size.y() - radius_) {
     v_.y() *= -1;
-    x_.y() = SCREEN_HEIGHT - radius_;
+    x_.y() = box_size.y() - radius_;
   }
-#endif
 }
 
-void Body::draw(sf::RenderWindow& window, sf::CircleShape& circle_mesh) const {
+void Body::wrap_around(const Vector2f& box_size) {
+  x_.x() -= box_size.x() * std::floor(x_.x() / box_size.x());
+  x_.y() -= box_size.y() * std::floor(x_.y() / box_size.y());
+}
+
+void Body::draw(sf::RenderTarget& target, sf::CircleShape& circle_mesh) const {
   circle_mesh.setScale({1.0, 1.0});
   circle_mesh.setOrigin({1.0, 1.0});
 
   circle_mesh.setScale({radius_, radius_});
   circle_mesh.setPosition({x_.x(), x_.y()});
   circle_mesh.setFillColor(color_);
-  window.draw(circle_mesh);
+  target.draw(circle_mesh);
 }
 
 void Body::apply_force(const Vector2f& df) {
@@ -68,6 +92,14 @@ Vector2f Body::displacement_to(const Body& other) const {
   return other.x_ - x_;
 }
 
+std::vector<eAttributeType> Body::get_attribute_types() const {
+  std::vector<eAttributeType> types;
+  for (const auto& attribute : attributes_) {
+    types.push_back(attribute->get_type());
+  }
+  return types;
+}
+
 namespace {
 
 // 2D "cross product" ie. determenant of packed matrix
@@ -77,9 +109,8 @@ inline float cross2d(const Vector2f& a, const Vector2f& b) {
 
 }
 
-void Body::elastic_collide_with(Body& other, const float distance, const float dt) {
+void Body::elastic_collide_with(Body& other, const Vector2f& dist_vec, const float distance, const float dt) {
   // --- Resolve collision ---
-  const Vector2f dist_vec = other.x_ - x_;
   const Vector2f v_diff = other.v_ - v_;
   const float total_mass = mass_ + other.mass_;
 
@@ -105,13 +136,13 @@ void Body::elastic_collide_with(Body& other, const float distance, const float d
   other.v_ += dv_1 * COLLISION_DAMPING;
 }
 
-void Body::correct_overlap_with(Body& other, const float distance) {
+void Body::correct_overlap_with(Body& other, const Vector2f& dist_vec, const float distance) {
   // Move the bodies apart so they are not overlapping (this would cause issues)
   // NOTE: TODO - Maybe this is causing the spinning - not conserving angular momentum.
   //       Should instead shift the planet's along their trajectory?
   //        
 
-  const Vector2f norm = (other.x_ - x_) / distance;  // Normal to collision
+  const Vector2f norm = dist_vec / distance;  // Normal to collision
   // Here, calculate the overlap (dx) between the bodies. Both need to move apart by this amount.
   // Should conserve centre of mass though. Hence needs weighting, not just moving by 0.5 * dx.
   const Vector2f overlap_vec = norm * (distance - radius_ - other.radius_);
@@ -21,25 +21,46 @@ class Body {
        float radius, float mass);
 
   // -- Rendering --
-  void draw(sf::RenderWindow& window, sf::CircleShape& circle_mesh) const;
+  void draw(sf::RenderTarget& target, sf::CircleShape& circle_mesh) const;
   void render_acc(sf::RenderTarget &target) const;
 
   // -- Physics --
   void step(const float dt);
+  void bounce_off_walls(const Vector2f& box_size);
+  void wrap_around(const Vector2f& box_size);
   void apply_force(const Vector2f& force);
   void reset_forces() { force_.x() = 0.0; force_.y() = 0.0; };
+  // For integrators other than step()
+  void kick(const Vector2f& force, const float dt) { v_ += force * dt / mass_; }
+  void set_state(const Vector2f& position, const Vector2f& velocity) { x_ = position; v_ = velocity; }
+
+  //    Sleeping - a sleeping body is not stepped and its contacts with other sleepers are skipped
+  bool is_asleep() const { return asleep_; }
+  void sleep();
+  void wake();
+  // Count of consecutive calls where the body was slower than max_speed
+  unsigned update_stillness(const float max_speed);
+  unsigned get_still_frames() const { return still_frames_; }
+  // How much the force has changed since falling asleep
+  Vector2f force_change_since_sleep() const { return force_ - sleep_force_; }
 
   //    Collisions
-  void elastic_collide_with(Body& other, const float distance, const float dt);
-  void correct_overlap_with(Body& other, const float distance);
+  //    dist_vec is the displacement to other (may be to a periodic image of it)
+  void elastic_collide_with(Body& other, const Vector2f& dist_vec, const float distance, const float dt);
+  void correct_overlap_with(Body& other, const Vector2f& dist_vec, const float distance);
   
   // -- Getters / tools --
   float get_radius() const { return radius_; }
   float get_mass() const { return mass_; }
+  const Vector2f& get_position() const { return x_; }
+  const Vector2f& get_velocity() const { return v_; }
+  const Vector2f& get_force() const { return force_; }
+  sf::Color get_color() const { return color_; }
   Vector2f displacement_to(const Body& other) const;
 
   template<typename Attr>
   bool has_attribute() const;
+  std::vector<eAttributeType> get_attribute_types() const;
 
   // WARNING: Only do this after checking there is an attribute
   template<typename Attr>
@@ -54,6 +75,10 @@ class Body {
   float mass_;
   float radius_;
 
+  bool asleep_ = false;
+  unsigned still_frames_ = 0;
+  Vector2f sleep_force_ = Vector2f::Zero();   // Force when put to sleep
+
   std::vector<std::shared_ptr<fields::Attribute>> attributes_;
 };
 
@@ -4,6 +4,7 @@
 #include "BodyBuilder.h"
 #include "Fields/GravityAttribute.h"
 #include "Fields/ChargeAttribute.h"
+#include "Fields/ScreenedChargeAttribute.h"
 
 BodyBuilder::BodyBuilder(const Vector2f& pos, const Vector2f& vel,
                          const float radius) :
@@ -38,3 +39,9 @@ BodyBuilder& BodyBuilder::with_charge(const bool sign) {
   return with_charge((static_cast<float>(sign) - 0.5f) * 2.0f);
 }
 
+
+BodyBuilder& BodyBuilder::with_screened_charge(const float charge) {
+  std::cout << "making with screened charge..." << std::endl;
+  with_attribute<fields::ScreenedChargeAttribute>(charge);
+  return *this;
+}
@@ -28,6 +28,7 @@ class BodyBuilder {
   BodyBuilder& with_gravity();
   BodyBuilder& with_charge(const float charge);
   BodyBuilder& with_charge(const bool sign);
+  BodyBuilder& with_screened_charge(const float charge);
 
   // Finalise
   Body build() const { return result_; }
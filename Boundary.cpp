@@ -0,0 +1,26 @@
+#include "Boundary.h"
+
+#include "Body.h"
+
+const char* boundary_mode_name(const eBoundaryMode mode) {
+  switch (mode) {
+    case eOpenBoundary:       return "open";
+    case eReflectingBoundary: return "reflecting";
+    case ePeriodicBoundary:   return "periodic";
+    default:                  return "NOT A MODE";
+  }
+}
+
+void Boundary::apply(Body& body) const {
+  switch (mode_) {
+    case eReflectingBoundary:
+      body.bounce_off_walls(size_);
+      break;
+    case ePeriodicBoundary:
+      body.wrap_around(size_);
+      break;
+    default:
+      break;
+  }
+}
+
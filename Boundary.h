@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+using Eigen::Vector2f;
+
+class Body;
+
+enum eBoundaryMode {
+  eOpenBoundary,        // Bodies can leave the screen
+  eReflectingBoundary,  // Bounce off the screen edges
+  ePeriodicBoundary,    // Leaving one side enters the other, forces/collisions use the nearest image
+};
+
+const char* boundary_mode_name(const eBoundaryMode mode);
+
+// The box bodies live in, and how they interact with its edges.
+class Boundary {
+ public:
+  Boundary(const eBoundaryMode mode, const float width, const float height) :
+    mode_(mode), size_(width, height)
+  {}
+
+  eBoundaryMode get_mode() const { return mode_; }
+  void set_mode(const eBoundaryMode mode) { mode_ = mode; }
+  bool is_periodic() const { return mode_ == ePeriodicBoundary; }
+  const Vector2f& get_size() const { return size_; }
+
+  // Displacement from a to b. In a periodic box this is to the nearest image of b.
+  Vector2f displacement(const Vector2f& a, const Vector2f& b) const {
+    Vector2f d = b - a;
+    if (is_periodic()) {
+      d.x() -= size_.x() * std::round(d.x() / size_.x());
+      d.y() -= size_.y() * std::round(d.y() / size_.y());
+    }
+    return d;
+  }
+
+  // Reflect or wrap the body after it has moved
+  void apply(Body& body) const;
+
+ private:
+  eBoundaryMode mode_;
+  Vector2f size_;
+};
+
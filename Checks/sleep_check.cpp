@@ -0,0 +1,113 @@
+// Sleeping regression check: ./orbits_sleep_check
+// A settled pile must stay asleep while an unrelated body moves around far away from it, and
+// a body thrown at it must wake it and collide exactly as if it had never slept.
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "../common.h"
+#include "../Simulation.h"
+#include "../BodyBuilder.h"
+
+namespace {
+
+constexpr float DT = 1.0 / 60.0;
+constexpr size_t PILE_SIDE = 10;
+constexpr float PILE_RADIUS = 5.0;
+constexpr float FAR_DISTANCE = 800.0;
+constexpr float FAR_SPEED = 50.0;
+constexpr size_t STEPS_AFTER = 200;
+constexpr float HIT_SPEED = 120.0;
+constexpr size_t HIT_STEPS = 30;           // Long enough for the first few contacts
+constexpr float HIT_TOLERANCE = 1e-3;      // Velocity difference allowed, in pixels per second
+
+// Bodies 0 .. PILE_SIDE^2 - 1, touching and at rest
+size_t add_pile(Simulation& sim) {
+  for (size_t row = 0; row < PILE_SIDE; ++row) {
+    for (size_t col = 0; col < PILE_SIDE; ++col) {
+      sim.add_body(BodyBuilder(Vector2f(100.0 + 2 * PILE_RADIUS * col, 100.0 + 2 * PILE_RADIUS * row),
+                               Vector2f::Zero(), PILE_RADIUS).build());
+    }
+  }
+  return PILE_SIDE * PILE_SIDE;
+}
+
+void settle(Simulation& sim) {
+  for (size_t s = 0; s < SLEEP_FRAMES + 2; ++s) {
+    sim.step(DT);
+  }
+}
+
+// Thrown at the left edge of the pile, in line with its first row. It comes after the pile, so
+// the body it hits has the lower index. The gap closes 2px per step and starts at 11.5px, so it
+// jumps from 1.5px (outside SLEEP_CONTACT_MARGIN) straight to overlapping.
+size_t add_hitter(Simulation& sim) {
+  sim.add_body(BodyBuilder(Vector2f(100.0 - 4 * PILE_RADIUS - 1.5, 100.0), Vector2f(HIT_SPEED, 0.0), PILE_RADIUS).build());
+  return sim.get_bodies().size() - 1;
+}
+
+bool check(const bool passed, const std::string& what) {
+  std::cout << what << std::endl;
+  if (!passed) std::cout << "CHECK FAILED" << std::endl;
+  return passed;
+}
+
+}  // namespace
+
+int main() {
+  // -- Far away motion leaves the pile asleep --
+  Simulation sim;
+  const size_t pile = add_pile(sim);
+  settle(sim);
+  if (!check(sim.count_asleep() == pile,
+             "pile settled: " + std::to_string(sim.count_asleep()) + "/" + std::to_string(pile) + " asleep")) {
+    return 1;
+  }
+
+  sim.add_body(BodyBuilder(Vector2f(100.0 + FAR_DISTANCE, 100.0), Vector2f(0.0, FAR_SPEED), PILE_RADIUS).build());
+  size_t min_asleep = pile;
+  for (size_t s = 0; s < STEPS_AFTER; ++s) {
+    sim.step(DT);
+    min_asleep = std::min(min_asleep, sim.count_asleep());
+  }
+  if (!check(min_asleep == pile,
+             "with a body " + std::to_string(FAR_DISTANCE) + "px away: at least " + std::to_string(min_asleep) +
+             "/" + std::to_string(pile) + " asleep over " + std::to_string(STEPS_AFTER) + " steps")) {
+    return 1;
+  }
+
+  // -- A hit wakes the pile and transfers the same momentum as with sleeping off --
+  Simulation sleeping;
+  Simulation reference;
+  reference.set_sleeping_enabled(false);
+  for (Simulation* s : {&sleeping, &reference}) {
+    add_pile(*s);
+    settle(*s);
+    add_hitter(*s);
+  }
+  const size_t hitter = pile;
+  const size_t struck = 0;
+
+  size_t woken = 0;
+  float max_difference = 0.0;
+  for (size_t s = 0; s < HIT_STEPS; ++s) {
+    sleeping.step(DT);
+    reference.step(DT);
+    woken = std::max(woken, pile - std::min(pile, sleeping.count_asleep()));
+    for (size_t i = 0; i < sleeping.get_bodies().size(); ++i) {
+      max_difference = std::max(max_difference, (sleeping.get_bodies()[i].get_velocity() -
+                                                  reference.get_bodies()[i].get_velocity()).norm());
+    }
+  }
+  const float hitter_speed = sleeping.get_bodies()[hitter].get_velocity().norm();
+  const float struck_speed = sleeping.get_bodies()[struck].get_velocity().norm();
+  if (!check(woken > 0 && hitter_speed < 0.9f * HIT_SPEED && struck_speed > 0.0f &&
+             max_difference < HIT_TOLERANCE,
+             "hit by a body: " + std::to_string(woken) + "/" + std::to_string(pile) + " woken, hitter " +
+             std::to_string(hitter_speed) + "px/s, struck body " + std::to_string(struck_speed) +
+             "px/s, largest velocity difference to sleeping off " + std::to_string(max_difference))) {
+    return 1;
+  }
+  return 0;
+}
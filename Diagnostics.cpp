@@ -0,0 +1,55 @@
+#include "Diagnostics.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Drift relative to the starting value, falls back to absolute when that is ~0
+double relative_drift(const double start, const double now) {
+  const double scale = std::abs(start);
+  return scale > 1e-12 ? (now - start) / scale : now - start;
+}
+
+// Same for a vector, as the size of the change
+double relative_drift(const Vector2d& start, const Vector2d& now) {
+  const double scale = start.norm();
+  return scale > 1e-12 ? (now - start).norm() / scale : (now - start).norm();
+}
+
+}  // namespace
+
+DiagnosticsLog::DiagnosticsLog(const size_t interval, const std::string& path) :
+  interval_(interval), file_(path)
+{
+  file_ << "step,time,kinetic,potential,total,momentum_x,momentum_y,angular_momentum,"
+           "energy_drift,momentum_x_drift,momentum_y_drift,angular_momentum_drift\n";
+}
+
+void DiagnosticsLog::record(const Diagnostics& sample) {
+  if (!has_first_) {
+    first_ = sample;
+    has_first_ = true;
+  }
+  last_ = sample;
+
+  file_ << sample.step << ',' << sample.time << ','
+        << sample.kinetic << ',' << sample.potential << ',' << sample.total_energy() << ','
+        << sample.momentum.x() << ',' << sample.momentum.y() << ',' << sample.angular_momentum << ','
+        << relative_drift(first_.total_energy(), sample.total_energy()) << ','
+        << relative_drift(first_.momentum.x(), sample.momentum.x()) << ','
+        << relative_drift(first_.momentum.y(), sample.momentum.y()) << ','
+        << relative_drift(first_.angular_momentum, sample.angular_momentum) << '\n';
+}
+
+std::string DiagnosticsLog::summary() const {
+  if (!has_first_) return "";
+
+  char line[200];
+  std::snprintf(line, sizeof(line), "E %.4g (drift %+.2e)  |p| %.3g (drift %.2e)  L %.4g (drift %+.2e)",
+                last_.total_energy(), relative_drift(first_.total_energy(), last_.total_energy()),
+                last_.momentum.norm(), relative_drift(first_.momentum, last_.momentum),
+                last_.angular_momentum, relative_drift(first_.angular_momentum, last_.angular_momentum));
+  return line;
+}
+
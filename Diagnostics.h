@@ -0,0 +1,44 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#include <Eigen/Dense>
+
+using Eigen::Vector2d;
+
+// Conserved quantities at one step. Potential energy comes out of the force pass.
+struct Diagnostics {
+  size_t step = 0;
+  double time = 0.0;
+  double kinetic = 0.0;
+  double potential = 0.0;            // Gravity + all charge fields
+  Vector2d momentum = Vector2d::Zero();
+  double angular_momentum = 0.0;     // About the origin, z component
+
+  double total_energy() const { return kinetic + potential; }
+};
+
+// Records Diagnostics every `interval` steps to a CSV file, and tracks drift since the
+// first sample (after the last reset).
+class DiagnosticsLog {
+ public:
+  DiagnosticsLog(const size_t interval, const std::string& path);
+
+  bool wants_sample(const size_t step) const { return step % interval_ == 0; }
+  void record(const Diagnostics& sample);
+  // Start measuring drift again, e.g after bodies are added or removed
+  void reset() { has_first_ = false; }
+
+  // One line summary for on screen display
+  std::string summary() const;
+
+ private:
+  size_t interval_;
+  std::ofstream file_;
+
+  bool has_first_ = false;
+  Diagnostics first_;
+  Diagnostics last_;
+};
+
@@ -0,0 +1,49 @@
+#include "BodyState.h"
+
+#include "../BodyBuilder.h"
+#include "../Fields/GravityAttribute.h"
+#include "../Fields/ChargeAttribute.h"
+#include "../Fields/ScreenedChargeAttribute.h"
+
+namespace distributed {
+
+BodyState BodyState::from_body(const Body& body, const uint64_t id) {
+  BodyState s{};
+  s.id = id;
+  s.x[0] = body.get_position().x();
+  s.x[1] = body.get_position().y();
+  s.v[0] = body.get_velocity().x();
+  s.v[1] = body.get_velocity().y();
+  s.mass = body.get_mass();
+  s.radius = body.get_radius();
+
+  const sf::Color color = body.get_color();
+  s.color[0] = color.r;
+  s.color[1] = color.g;
+  s.color[2] = color.b;
+  s.color[3] = color.a;
+
+  s.has_gravity = body.has_attribute<fields::GravityAttribute>();
+  s.has_charge = body.has_attribute<fields::ChargeAttribute>();
+  if (s.has_charge) s.charge = body.get_attribute<fields::ChargeAttribute>().get_charge();
+  s.has_screened_charge = body.has_attribute<fields::ScreenedChargeAttribute>();
+  if (s.has_screened_charge) {
+    s.screened_charge = body.get_attribute<fields::ScreenedChargeAttribute>().get_charge();
+  }
+  return s;
+}
+
+Body BodyState::to_body() const {
+  // Attributes are added directly rather than through with_gravity() etc. so colours are kept
+  // and nothing is logged.
+  BodyBuilder builder(Vector2f(x[0], x[1]), Vector2f(v[0], v[1]), radius);
+  builder.set_mass(mass)
+         .set_color(sf::Color(color[0], color[1], color[2], color[3]));
+  if (has_gravity) builder.with_attribute<fields::GravityAttribute>();
+  if (has_charge) builder.with_attribute<fields::ChargeAttribute>(charge);
+  if (has_screened_charge) builder.with_attribute<fields::ScreenedChargeAttribute>(screened_charge);
+  return builder.build();
+}
+
+}  // namespace distributed
+
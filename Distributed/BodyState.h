@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../Body.h"
+
+namespace distributed {
+
+// Plain copy of a body that can be sent between ranks as bytes.
+struct BodyState {
+  uint64_t id;
+  float x[2];
+  float v[2];
+  float mass;
+  float radius;
+  float charge;
+  float screened_charge;
+  uint8_t color[4];
+  uint8_t has_gravity;
+  uint8_t has_charge;
+  uint8_t has_screened_charge;
+  uint8_t padding;
+
+  static BodyState from_body(const Body& body, const uint64_t id);
+  Body to_body() const;
+};
+
+}  // namespace distributed
+
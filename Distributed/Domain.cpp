@@ -0,0 +1,351 @@
+#include "Domain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#include "../common.h"
+#include "../Fields/GravityAttribute.h"
+#include "../Fields/ChargeAttribute.h"
+
+namespace distributed {
+
+namespace {
+
+constexpr int ROOT = 0;
+
+// Force on a body as computed by its owner
+struct ForceState {
+  float f[2];
+};
+
+// Send send[r] to rank r, returns everything received concatenated in rank order.
+template<typename T>
+std::vector<T> all_to_all(const std::vector<std::vector<T>>& send, MPI_Comm comm) {
+  const int size = static_cast<int>(send.size());
+  std::vector<int> send_counts(size), send_displs(size), recv_counts(size), recv_displs(size);
+
+  std::vector<T> send_flat;
+  for (int r = 0; r < size; ++r) {
+    send_counts[r] = static_cast<int>(send[r].size() * sizeof(T));
+    send_displs[r] = static_cast<int>(send_flat.size() * sizeof(T));
+    send_flat.insert(send_flat.end(), send[r].begin(), send[r].end());
+  }
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+
+  int total = 0;
+  for (int r = 0; r < size; ++r) {
+    recv_displs[r] = total;
+    total += recv_counts[r];
+  }
+  std::vector<T> received(total / sizeof(T));
+  MPI_Alltoallv(send_flat.data(), send_counts.data(), send_displs.data(), MPI_BYTE,
+                received.data(), recv_counts.data(), recv_displs.data(), MPI_BYTE, comm);
+  return received;
+}
+
+// Boundaries that split the sorted x positions into equal sized groups
+std::vector<float> balanced_boundaries(std::vector<float> xs, const int size) {
+  std::vector<float> boundaries(size + 1);
+  boundaries.front() = -std::numeric_limits<float>::infinity();
+  boundaries.back() = std::numeric_limits<float>::infinity();
+
+  std::sort(xs.begin(), xs.end());
+  for (int r = 1; r < size; ++r) {
+    if (xs.empty()) {
+      boundaries[r] = SCREEN_WIDTH * static_cast<float>(r) / static_cast<float>(size);
+    } else {
+      boundaries[r] = xs[xs.size() * r / size];
+    }
+  }
+  return boundaries;
+}
+
+}  // namespace
+
+Domain::Domain(MPI_Comm comm) :
+  comm_(comm)
+{
+  MPI_Comm_rank(comm_, &rank_);
+  MPI_Comm_size(comm_, &size_);
+  boundaries_ = balanced_boundaries({}, size_);
+}
+
+void Domain::scatter(const std::vector<Body>& bodies) {
+  std::vector<std::vector<BodyState>> send(size_);
+  if (rank_ == ROOT) {
+    std::vector<float> xs;
+    for (const auto& body : bodies) xs.push_back(body.get_position().x());
+    boundaries_ = balanced_boundaries(xs, size_);
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+      send[owner_of(bodies[i].get_position().x())].push_back(BodyState::from_body(bodies[i], i));
+    }
+  }
+  MPI_Bcast(boundaries_.data(), size_ + 1, MPI_FLOAT, ROOT, comm_);
+
+  set_owned(all_to_all(send, comm_));
+}
+
+std::vector<BodyState> Domain::gather() const {
+  std::vector<BodyState> owned;
+  const auto& bodies = local_.get_bodies();
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    owned.push_back(BodyState::from_body(bodies[i], ids_[i]));
+  }
+
+  const int send_bytes = static_cast<int>(owned.size() * sizeof(BodyState));
+  std::vector<int> counts(size_), displs(size_);
+  MPI_Gather(&send_bytes, 1, MPI_INT, counts.data(), 1, MPI_INT, ROOT, comm_);
+
+  int total = 0;
+  for (int r = 0; r < size_; ++r) {
+    displs[r] = total;
+    total += counts[r];
+  }
+
+  std::vector<BodyState> all(rank_ == ROOT ? total / sizeof(BodyState) : 0);
+  MPI_Gatherv(owned.data(), send_bytes, MPI_BYTE,
+              all.data(), counts.data(), displs.data(), MPI_BYTE, ROOT, comm_);
+
+  std::sort(all.begin(), all.end(),
+            [](const BodyState& a, const BodyState& b) { return a.id < b.id; });
+  return all;
+}
+
+void Domain::step(const float dt) {
+  auto& bodies = local_.get_bodies();
+  const size_t owned = bodies.size();
+
+  // -- Fields: exact between owned and nearby ghosts, summaries for the rest --
+  const std::vector<RemoteCell> cells = exchange_summaries();
+  std::vector<std::vector<size_t>> sent;
+  for (const auto& ghost : exchange_ghosts(&sent)) bodies.push_back(ghost.to_body());
+  local_.bodies_changed();
+
+  local_.reset_forces();
+  local_.apply_fields(dt);
+  apply_far_field(cells);
+
+  // Ghosts are kept through the integration so close encounters across a boundary are
+  // sub-stepped together. Their force here only counts what this rank can see, so it is
+  // replaced by the owner's, which is what the encounter integrator holds fixed. Both ranks
+  // then integrate the same cluster from the same state, and each keeps its own bodies.
+  const std::vector<Vector2f> ghost_forces = exchange_ghost_forces(sent);
+  for (size_t g = 0; g < ghost_forces.size(); ++g) {
+    Body& ghost = bodies[owned + g];
+    ghost.reset_forces();
+    ghost.apply_force(ghost_forces[g]);
+  }
+  local_.integrate(dt);
+  bodies.erase(bodies.begin() + owned, bodies.end());
+  local_.bodies_changed();
+
+  // -- Contacts: against ghosts at their new positions. Changes to ghosts are thrown away,
+  //    their owners resolve the same pair themselves. --
+  for (const auto& ghost : exchange_ghosts()) bodies.push_back(ghost.to_body());
+  local_.bodies_changed();
+  local_.resolve_contacts(dt);
+  bodies.erase(bodies.begin() + owned, bodies.end());
+  local_.bodies_changed();
+
+  migrate();
+  if (++step_count_ % REBALANCE_INTERVAL == 0) rebalance();
+}
+
+void Domain::rebalance() {
+  std::vector<float> xs;
+  for (const auto& body : local_.get_bodies()) xs.push_back(body.get_position().x());
+
+  const int count = static_cast<int>(xs.size());
+  std::vector<int> counts(size_), displs(size_);
+  MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, ROOT, comm_);
+
+  int total = 0;
+  for (int r = 0; r < size_; ++r) {
+    displs[r] = total;
+    total += counts[r];
+  }
+  std::vector<float> all_xs(rank_ == ROOT ? total : 0);
+  MPI_Gatherv(xs.data(), count, MPI_FLOAT,
+              all_xs.data(), counts.data(), displs.data(), MPI_FLOAT, ROOT, comm_);
+
+  if (rank_ == ROOT) boundaries_ = balanced_boundaries(all_xs, size_);
+  MPI_Bcast(boundaries_.data(), size_ + 1, MPI_FLOAT, ROOT, comm_);
+
+  migrate();
+}
+
+std::vector<BodyState> Domain::exchange_ghosts(std::vector<std::vector<size_t>>* sent) const {
+  std::vector<std::vector<BodyState>> send(size_);
+  const auto& bodies = local_.get_bodies();
+  if (sent) sent->assign(size_, {});
+
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    const float centre_x = cell_centre_of(bodies[i].get_position()).x();
+    for (int r = 0; r < size_; ++r) {
+      if (r != rank_ && is_near(centre_x, r)) {
+        send[r].push_back(BodyState::from_body(bodies[i], ids_[i]));
+        if (sent) (*sent)[r].push_back(i);
+      }
+    }
+  }
+  return all_to_all(send, comm_);
+}
+
+std::vector<Vector2f> Domain::exchange_ghost_forces(const std::vector<std::vector<size_t>>& sent) const {
+  std::vector<std::vector<ForceState>> send(size_);
+  const auto& bodies = local_.get_bodies();
+
+  for (int r = 0; r < size_; ++r) {
+    for (const size_t i : sent[r]) {
+      const Vector2f& force = bodies[i].get_force();
+      send[r].push_back({{force.x(), force.y()}});
+    }
+  }
+
+  std::vector<Vector2f> forces;
+  for (const auto& state : all_to_all(send, comm_)) {
+    forces.emplace_back(state.f[0], state.f[1]);
+  }
+  return forces;
+}
+
+std::vector<Domain::RemoteCell> Domain::exchange_summaries() const {
+  // Bin owned bodies into cells
+  std::unordered_map<int64_t, CellSummary> cells;
+  for (const auto& body : local_.get_bodies()) {
+    const Vector2f centre = cell_centre_of(body.get_position());
+    const int32_t cx = static_cast<int32_t>(std::floor(centre.x() / SUMMARY_CELL_SIZE));
+    const int32_t cy = static_cast<int32_t>(std::floor(centre.y() / SUMMARY_CELL_SIZE));
+    const int64_t key = (static_cast<int64_t>(cx) << 32) | static_cast<uint32_t>(cy);
+
+    auto [it, inserted] = cells.try_emplace(key);
+    CellSummary& cell = it->second;
+    if (inserted) {
+      cell.centre[0] = centre.x();
+      cell.centre[1] = centre.y();
+    }
+
+    const Vector2f offset = body.get_position() - centre;
+    if (body.has_attribute<fields::GravityAttribute>()) {
+      cell.gravity.add_source(offset, body.get_mass());
+    }
+    if (body.has_attribute<fields::ChargeAttribute>()) {
+      cell.charge.add_source(offset, body.get_attribute<fields::ChargeAttribute>().get_charge());
+    }
+  }
+
+  std::vector<CellSummary> mine;
+  for (const auto& [key, cell] : cells) mine.push_back(cell);
+
+  // Everyone gets everyone's cells
+  const int send_bytes = static_cast<int>(mine.size() * sizeof(CellSummary));
+  std::vector<int> counts(size_), displs(size_);
+  MPI_Allgather(&send_bytes, 1, MPI_INT, counts.data(), 1, MPI_INT, comm_);
+
+  int total = 0;
+  for (int r = 0; r < size_; ++r) {
+    displs[r] = total;
+    total += counts[r];
+  }
+  std::vector<CellSummary> all(total / sizeof(CellSummary));
+  MPI_Allgatherv(mine.data(), send_bytes, MPI_BYTE,
+                 all.data(), counts.data(), displs.data(), MPI_BYTE, comm_);
+
+  // Keep cells from other ranks that are too far away to have been sent as ghosts
+  std::vector<RemoteCell> remote;
+  for (int r = 0; r < size_; ++r) {
+    if (r == rank_) continue;
+
+    const size_t first = displs[r] / sizeof(CellSummary);
+    const size_t last = first + counts[r] / sizeof(CellSummary);
+    for (size_t c = first; c < last; ++c) {
+      if (!is_near(all[c].centre[0], rank_)) remote.push_back({r, all[c]});
+    }
+  }
+  return remote;
+}
+
+void Domain::migrate() {
+  std::vector<std::vector<BodyState>> send(size_);
+  auto& bodies = local_.get_bodies();
+
+  // Compact the bodies staying here, pack the ones leaving
+  size_t kept = 0;
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    const int owner = owner_of(bodies[i].get_position().x());
+    if (owner == rank_) {
+      if (kept != i) {
+        bodies[kept] = bodies[i];
+        ids_[kept] = ids_[i];
+      }
+      ++kept;
+    } else {
+      send[owner].push_back(BodyState::from_body(bodies[i], ids_[i]));
+    }
+  }
+  bodies.erase(bodies.begin() + kept, bodies.end());
+  ids_.resize(kept);
+
+  for (const auto& state : all_to_all(send, comm_)) {
+    bodies.push_back(state.to_body());
+    ids_.push_back(state.id);
+  }
+  local_.bodies_changed();
+}
+
+void Domain::set_owned(const std::vector<BodyState>& states) {
+  local_.clear();
+  ids_.clear();
+  for (const auto& state : states) {
+    local_.add_body(state.to_body());
+    ids_.push_back(state.id);
+  }
+}
+
+void Domain::apply_far_field(const std::vector<RemoteCell>& cells) {
+  auto& bodies = local_.get_bodies();
+
+  for (const size_t i : local_.get_index().members<fields::GravityAttribute>()) {
+    Body& body = bodies[i];
+    Vector2f force = Vector2f::Zero();
+    for (const auto& cell : cells) {
+      if (cell.summary.gravity.weight == 0.0f) continue;
+      const Vector2f to_centre = Vector2f(cell.summary.centre[0], cell.summary.centre[1]) - body.get_position();
+      force += G * body.get_mass() * cell.summary.gravity.field_at(to_centre);
+    }
+    body.apply_force(force);
+  }
+
+  for (const size_t i : local_.get_index().members<fields::ChargeAttribute>()) {
+    Body& body = bodies[i];
+    const float charge = body.get_attribute<fields::ChargeAttribute>().get_charge();
+    Vector2f force = Vector2f::Zero();
+    for (const auto& cell : cells) {
+      const Vector2f to_centre = Vector2f(cell.summary.centre[0], cell.summary.centre[1]) - body.get_position();
+      force += -COULOMB * charge * cell.summary.charge.field_at(to_centre);
+    }
+    body.apply_force(force);
+  }
+}
+
+int Domain::owner_of(const float x) const {
+  const auto it = std::upper_bound(boundaries_.begin(), boundaries_.end(), x);
+  const int owner = static_cast<int>(it - boundaries_.begin()) - 1;
+  return std::clamp(owner, 0, size_ - 1);
+}
+
+bool Domain::is_near(const float x, const int rank) const {
+  const float distance = std::max({boundaries_[rank] - x, x - boundaries_[rank + 1], 0.0f});
+  return distance <= NEAR_FIELD_DIST;
+}
+
+Vector2f Domain::cell_centre_of(const Vector2f& x) {
+  return Vector2f((std::floor(x.x() / SUMMARY_CELL_SIZE) + 0.5f) * SUMMARY_CELL_SIZE,
+                  (std::floor(x.y() / SUMMARY_CELL_SIZE) + 0.5f) * SUMMARY_CELL_SIZE);
+}
+
+}  // namespace distributed
+
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <mpi.h>
+
+#include "../Simulation.h"
+#include "BodyState.h"
+#include "Multipole.h"
+
+namespace distributed {
+
+// One rank's slab of the plane, x in [boundaries_[rank], boundaries_[rank+1]).
+// Bodies within NEAR_FIELD_DIST of the slab are exchanged as ghosts (exact forces and
+// collisions); everything further away only arrives as per-cell multipole summaries.
+class Domain {
+ public:
+  Domain(MPI_Comm comm);
+
+  // Root passes every body, other ranks pass nothing. Ids are the index in the root's vector.
+  void scatter(const std::vector<Body>& bodies);
+  // Collect every body on root, sorted by id. Other ranks get an empty vector.
+  std::vector<BodyState> gather() const;
+
+  void step(const float dt);
+  // Move boundaries so each rank owns about the same number of bodies
+  void rebalance();
+
+  int get_rank() const { return rank_; }
+  size_t get_owned_count() const { return ids_.size(); }
+
+ private:
+  struct RemoteCell {
+    int rank;
+    CellSummary summary;
+  };
+
+  // -- Communication --
+  // If sent is given, it gets the local index of every body sent to each rank, in order
+  std::vector<BodyState> exchange_ghosts(std::vector<std::vector<size_t>>* sent = nullptr) const;
+  // Owners' forces for the ghosts from exchange_ghosts(&sent), in the same order
+  std::vector<Vector2f> exchange_ghost_forces(const std::vector<std::vector<size_t>>& sent) const;
+  std::vector<RemoteCell> exchange_summaries() const;
+  void migrate();
+  void set_owned(const std::vector<BodyState>& states);
+
+  // -- Physics --
+  void apply_far_field(const std::vector<RemoteCell>& cells);
+
+  // -- Geometry --
+  int owner_of(const float x) const;
+  bool is_near(const float x, const int rank) const;  // Cell centre within NEAR_FIELD_DIST of slab
+  static Vector2f cell_centre_of(const Vector2f& x);
+
+  MPI_Comm comm_;
+  int rank_;
+  int size_;
+  size_t step_count_ = 0;
+
+  std::vector<float> boundaries_;   // size_ + 1 entries, outer ones are +/- infinity
+  Simulation local_;                // Owned bodies only, ghosts are appended temporarily
+  std::vector<uint64_t> ids_;       // Parallel to local_'s bodies
+};
+
+}  // namespace distributed
+
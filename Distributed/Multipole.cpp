@@ -0,0 +1,40 @@
+#include "Multipole.h"
+
+#include <cmath>
+
+namespace distributed {
+
+void Multipole::add_source(const Vector2f& d, const float w) {
+  weight += w;
+  dipole[0] += w * d.x();
+  dipole[1] += w * d.y();
+  quadrupole[0] += w * d.x() * d.x();
+  quadrupole[1] += w * d.x() * d.y();
+  quadrupole[2] += w * d.y() * d.y();
+}
+
+Vector2f Multipole::field_at(const Vector2f& to_centre) const {
+  const Vector2f& R = to_centre;
+  const Vector2f D(dipole[0], dipole[1]);
+  Matrix2f Q;
+  Q << quadrupole[0], quadrupole[1],
+       quadrupole[1], quadrupole[2];
+
+  const float r2 = R.squaredNorm();
+  const float r = std::sqrt(r2);
+  const float inv_r3 = 1.0f / (r2 * r);
+  const float inv_r5 = inv_r3 / r2;
+  const float inv_r7 = inv_r5 / r2;
+
+  // Taylor expansion of y/|y|^3 about R, summed over the sources
+  const Vector2f monopole_term = weight * R * inv_r3;
+  const Vector2f dipole_term = D * inv_r3 - 3.0f * R * R.dot(D) * inv_r5;
+  const Vector2f quadrupole_term = -3.0f * (Q * R) * inv_r5
+                                   - 1.5f * Q.trace() * R * inv_r5
+                                   + 7.5f * R * R.dot(Q * R) * inv_r7;
+
+  return monopole_term + dipole_term + quadrupole_term;
+}
+
+}  // namespace distributed
+
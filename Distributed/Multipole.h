@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+using Eigen::Vector2f;
+using Eigen::Matrix2f;
+
+namespace distributed {
+
+// Second order expansion of a group of weighted sources (mass or charge) about a centre.
+// Sum of w * y/|y|^3 over the sources is then approximated for far away points.
+struct Multipole {
+  float weight = 0.0;
+  float dipole[2] = {0.0, 0.0};
+  float quadrupole[3] = {0.0, 0.0, 0.0};   // xx, xy, yy
+
+  // d is the source's offset from the centre
+  void add_source(const Vector2f& d, const float w);
+
+  // Approximates sum of w * (x_source - x)/|x_source - x|^3, where to_centre = centre - x
+  Vector2f field_at(const Vector2f& to_centre) const;
+};
+
+// What a rank knows about a cell of bodies owned by some other rank
+struct CellSummary {
+  float centre[2];
+  Multipole gravity;  // Weighted by mass, only bodies with gravity
+  Multipole charge;   // Weighted by charge
+};
+
+}  // namespace distributed
+
@@ -0,0 +1,94 @@
+// Headless distributed run: mpirun -np 4 ./orbits_mpi [steps] [--check]
+// With --check, root also runs the same start state in a single process and compares.
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <mpi.h>
+
+#include "../common.h"
+#include "../Simulation.h"
+#include "../Scenes.h"
+#include "Domain.h"
+
+namespace {
+
+constexpr float DT = 1.0 / 60.0;
+constexpr float CHECK_TOLERANCE = 1.0;   // RMS position error allowed, in pixels
+
+double seconds_since(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+
+  size_t steps = 120;   // Kept short by default, collisions make longer runs diverge from the check
+  bool check = false;
+  for (int a = 1; a < argc; ++a) {
+    if (std::strcmp(argv[a], "--check") == 0) {
+      check = true;
+    } else {
+      steps = std::stoul(argv[a]);
+    }
+  }
+
+  distributed::Domain domain(MPI_COMM_WORLD);
+  const bool root = domain.get_rank() == 0;
+
+  Simulation start;
+  start.set_sleeping_enabled(false);   // Domains don't sleep, so neither does the reference
+  if (root) scenes::start_state(start);
+  domain.scatter(start.get_bodies());
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  const auto start_time = std::chrono::steady_clock::now();
+  for (size_t s = 0; s < steps; ++s) {
+    domain.step(DT);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  const double distributed_time = seconds_since(start_time);
+
+  std::cout << "rank " << domain.get_rank() << " owns " << domain.get_owned_count() << " bodies" << std::endl;
+  const std::vector<distributed::BodyState> result = domain.gather();
+
+  int exit_code = 0;
+  if (root) {
+    std::cout << "BODY NUM: " << result.size() << ", " << steps << " steps in "
+              << distributed_time << "s" << std::endl;
+
+    if (check) {
+      const auto serial_start = std::chrono::steady_clock::now();
+      for (size_t s = 0; s < steps; ++s) {
+        start.step(DT);
+      }
+      std::cout << "single process: " << seconds_since(serial_start) << "s" << std::endl;
+
+      const auto& expected = start.get_bodies();
+      double sum_sqr = 0.0;
+      double max_error = 0.0;
+      for (const auto& state : result) {
+        const Vector2f diff = expected[state.id].get_position() - Vector2f(state.x[0], state.x[1]);
+        sum_sqr += diff.squaredNorm();
+        max_error = std::max(max_error, static_cast<double>(diff.norm()));
+      }
+      const double rms = std::sqrt(sum_sqr / std::max<size_t>(result.size(), 1));
+
+      std::cout << "position error vs single process: rms " << rms << ", max " << max_error << std::endl;
+      if (result.size() != expected.size() || !(rms < CHECK_TOLERANCE)) {
+        std::cout << "CHECK FAILED" << std::endl;
+        exit_code = 1;
+      }
+    }
+  }
+
+  MPI_Bcast(&exit_code, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Finalize();
+  return exit_code;
+}
+
@@ -0,0 +1,249 @@
+#include "Encounters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "common.h"
+#include "Fields/GravityAttribute.h"
+#include "Fields/ChargeAttribute.h"
+
+using Eigen::Vector2f;
+
+float EncounterIntegrator::strength(const Member& a, const Member& b) const {
+  float s = std::abs(COULOMB * a.charge * b.charge);
+  if (a.gravity && b.gravity) s += G * a.mass * b.mass;
+  return s * (1.0f / a.mass + 1.0f / b.mass);
+}
+
+float EncounterIntegrator::candidate_rate(const float dt) {
+  // Half, as gravity and charge are flagged by separate passes and a pair's strength is the sum
+  return 0.5f * ENCOUNTER_ETA * ENCOUNTER_ETA / (dt * dt);
+}
+
+void EncounterIntegrator::find(const std::vector<Body>& bodies, const fields::AttributeIndex& index,
+                               const Boundary& boundary, const float dt, const bool include_charge,
+                               std::vector<std::pair<size_t, size_t>> candidates) {
+  members_.clear();
+  pairs_.clear();
+  clusters_.clear();
+  cluster_of_.assign(bodies.size(), NONE);
+
+  // Everything with gravity or charge, both lists are sorted
+  const auto& gravity = index.members<fields::GravityAttribute>();
+  const auto& charge = index.members<fields::ChargeAttribute>();
+  std::vector<size_t> participants;
+  participants.reserve(gravity.size() + charge.size());
+  if (include_charge) {
+    std::set_union(gravity.begin(), gravity.end(), charge.begin(), charge.end(),
+                   std::back_inserter(participants));
+  } else {
+    participants = gravity;
+  }
+  std::vector<size_t> member_of(bodies.size(), NONE);
+  for (const size_t i : participants) {
+    const Body& body = bodies[i];
+    if (body.is_asleep()) continue;
+    member_of[i] = members_.size();
+    const bool charged = include_charge && body.has_attribute<fields::ChargeAttribute>();
+    members_.push_back({i, body.get_mass(),
+                        charged ? body.get_attribute<fields::ChargeAttribute>().get_charge() : 0.0f,
+                        body.has_attribute<fields::GravityAttribute>()});
+  }
+  if (members_.size() < 2) return;
+
+  // Candidates come from the force pass (a pair may be flagged by both gravity and charge),
+  // only they get the exact test: close when dt^2 * strength / d^3 > eta^2, or squared
+  // d^6 < limit^2 * strength^2 to avoid a sqrt
+  for (auto& [i, j] : candidates) {
+    if (i > j) std::swap(i, j);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  const float limit = dt * dt / (ENCOUNTER_ETA * ENCOUNTER_ETA);
+  for (const auto& [i, j] : candidates) {
+    if (member_of[i] == NONE || member_of[j] == NONE) continue;
+    const size_t m = member_of[i];
+    const size_t n = member_of[j];
+    const float d2 = boundary.displacement(bodies[i].get_position(), bodies[j].get_position()).squaredNorm();
+    // Touching pairs are left to the contact passes
+    const float touching = bodies[i].get_radius() + bodies[j].get_radius();
+    if (d2 < touching * touching) continue;
+    const float s = strength(members_[m], members_[n]);
+    if (d2 * d2 * d2 < limit * limit * s * s) {
+      pairs_.push_back({m, n});
+    }
+  }
+  if (pairs_.empty()) return;
+
+  // Pairs sharing a body are integrated together (union-find)
+  std::vector<size_t> parent(members_.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  const auto root = [&](size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  for (const Pair& pair : pairs_) {
+    parent[root(pair.a)] = root(pair.b);
+  }
+
+  std::vector<size_t> cluster_of_root(members_.size(), NONE);
+  for (const Pair& pair : pairs_) {
+    for (const size_t m : {pair.a, pair.b}) {
+      size_t& c = cluster_of_root[root(m)];
+      if (c == NONE) {
+        c = clusters_.size();
+        clusters_.emplace_back();
+      }
+      if (cluster_of_[members_[m].body] == NONE) {
+        cluster_of_[members_[m].body] = c;
+        clusters_[c].push_back(m);
+      }
+    }
+  }
+
+  // Big clusters are dense packings (e.g a charged lattice) rather than encounters, and cost
+  // O(k^2) per sub-step, so they are left to the Euler step
+  std::vector<std::vector<size_t>> kept;
+  for (auto& cluster : clusters_) {
+    const size_t c = cluster.size() > ENCOUNTER_MAX_CLUSTER ? NONE : kept.size();
+    for (const size_t m : cluster) {
+      cluster_of_[members_[m].body] = c;
+    }
+    if (c != NONE) kept.push_back(std::move(cluster));
+  }
+  clusters_ = std::move(kept);
+  pairs_.erase(std::remove_if(pairs_.begin(), pairs_.end(),
+                              [&](const Pair& pair) { return !contains(members_[pair.a].body); }),
+               pairs_.end());
+}
+
+void EncounterIntegrator::integrate(std::vector<Body>& bodies, const Boundary& boundary, const float dt,
+                                    const PairForce& pair_force) const {
+  for (const auto& cluster : clusters_) {
+    integrate_cluster(bodies, boundary, dt, pair_force, cluster);
+  }
+}
+
+void EncounterIntegrator::integrate_cluster(std::vector<Body>& bodies, const Boundary& boundary,
+                                            const float dt, const PairForce& pair_force,
+                                            const std::vector<size_t>& cluster) const {
+  const size_t k = cluster.size();
+  const auto body = [&](const size_t c) -> Body& { return bodies[members_[cluster[c]].body]; };
+
+  // Positions are unwrapped around the first member, so periodic clusters are contiguous
+  const Vector2f anchor = body(0).get_position();
+  std::vector<Vector2f> x(k), v(k), external(k);
+  for (size_t c = 0; c < k; ++c) {
+    x[c] = anchor + boundary.displacement(anchor, body(c).get_position());
+    v[c] = body(c).get_velocity();
+    external[c] = body(c).get_force();
+    v[c] += external[c] * (0.5f * dt / body(c).get_mass());   // Level with the position
+  }
+
+  // Internal forces are recomputed every sub-step, the rest of the force pass is held fixed.
+  // While a pair overlaps (between sub-steps it bounces on) its force is held at the value at
+  // contact, rather than growing without bound.
+  const auto internal_forces = [&](const std::vector<Vector2f>& pos, std::vector<Vector2f>& out) {
+    std::fill(out.begin(), out.end(), Vector2f::Zero());
+    for (size_t c = 0; c < k; ++c) {
+      for (size_t d = c+1; d < k; ++d) {
+        Vector2f dist_vec = pos[d] - pos[c];
+        const float dist = dist_vec.norm();
+        const float touching = body(c).get_radius() + body(d).get_radius();
+        if (dist < touching) {
+          if (dist == 0.0f) continue;
+          dist_vec *= touching / dist;
+        }
+        const Vector2f f = pair_force(body(c), body(d), dist_vec);
+        out[c] += f;
+        out[d] -= f;
+      }
+    }
+  };
+  std::vector<Vector2f> force(k);
+  internal_forces(x, force);
+  for (size_t c = 0; c < k; ++c) {
+    external[c] -= force[c];
+  }
+
+  const auto accelerations = [&](const std::vector<Vector2f>& pos, std::vector<Vector2f>& out) {
+    internal_forces(pos, out);
+    for (size_t c = 0; c < k; ++c) {
+      out[c] = (out[c] + external[c]) / body(c).get_mass();
+    }
+  };
+
+  // Shortest dynamical time in the cluster, touching pairs count as at contact distance
+  const auto shortest_time = [&](const std::vector<Vector2f>& pos) {
+    float t_min = dt;
+    for (size_t c = 0; c < k; ++c) {
+      for (size_t d = c+1; d < k; ++d) {
+        const float dist = std::max((pos[d] - pos[c]).norm(), body(c).get_radius() + body(d).get_radius());
+        const float s = strength(members_[cluster[c]], members_[cluster[d]]);
+        if (s > 0.0f) t_min = std::min(t_min, std::sqrt(dist * dist * dist / s));
+      }
+    }
+    return t_min;
+  };
+
+  // Touching pairs that are still closing bounce as in Body::elastic_collide_with. The impulse
+  // goes to zero for a grazing or resting pair, so a small change in the start state only makes
+  // a small change to the outcome.
+  const auto bounce = [&](const std::vector<Vector2f>& pos, std::vector<Vector2f>& vel) {
+    for (size_t c = 0; c < k; ++c) {
+      for (size_t d = c+1; d < k; ++d) {
+        const Vector2f dist_vec = pos[d] - pos[c];
+        const float touching = body(c).get_radius() + body(d).get_radius();
+        const float closing = (vel[d] - vel[c]).dot(dist_vec);
+        if (closing >= 0.0f || dist_vec.squaredNorm() >= touching * touching) continue;
+        const float mass_c = body(c).get_mass();
+        const float mass_d = body(d).get_mass();
+        const Vector2f impulse = 2.0f * closing / ((mass_c + mass_d) * dist_vec.squaredNorm()) * dist_vec;
+        vel[c] += impulse * (mass_d * COLLISION_DAMPING);
+        vel[d] -= impulse * (mass_c * COLLISION_DAMPING);
+      }
+    }
+  };
+
+  // RK4 in (x, v)
+  std::vector<Vector2f> a1(k), a2(k), a3(k), a4(k), xt(k), v2(k), v3(k), v4(k);
+  float remaining = dt;
+  for (size_t sub = 0; remaining > 0.0f; ++sub) {
+    bounce(x, v);
+    float h = std::min(remaining, ENCOUNTER_SUBSTEP_ETA * shortest_time(x));
+    if (sub + 1 >= ENCOUNTER_MAX_SUBSTEPS) h = remaining;
+
+    accelerations(x, a1);
+    for (size_t c = 0; c < k; ++c) {
+      v2[c] = v[c] + 0.5f * h * a1[c];
+      xt[c] = x[c] + 0.5f * h * v[c];
+    }
+    accelerations(xt, a2);
+    for (size_t c = 0; c < k; ++c) {
+      v3[c] = v[c] + 0.5f * h * a2[c];
+      xt[c] = x[c] + 0.5f * h * v2[c];
+    }
+    accelerations(xt, a3);
+    for (size_t c = 0; c < k; ++c) {
+      v4[c] = v[c] + h * a3[c];
+      xt[c] = x[c] + h * v3[c];
+    }
+    accelerations(xt, a4);
+    for (size_t c = 0; c < k; ++c) {
+      x[c] += h / 6.0f * (v[c] + 2.0f * v2[c] + 2.0f * v3[c] + v4[c]);
+      v[c] += h / 6.0f * (a1[c] + 2.0f * a2[c] + 2.0f * a3[c] + a4[c]);
+    }
+    remaining -= h;
+  }
+
+  accelerations(x, a1);
+  for (size_t c = 0; c < k; ++c) {
+    body(c).set_state(x[c], v[c] - 0.5f * dt * a1[c]);   // Half a step behind again
+    boundary.apply(body(c));
+  }
+}
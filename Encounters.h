@@ -0,0 +1,67 @@
+#pragma once
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Body.h"
+#include "Boundary.h"
+#include "Fields/AttributeIndex.h"
+
+using Eigen::Vector2f;
+
+// Close encounters - pairs whose mutual gravity/charge changes too fast for one Euler step.
+// Touching groups of such pairs (clusters) are taken out of the global step and integrated
+// on their own with adaptive RK4 sub-steps, with forces from outside the cluster held fixed.
+//
+// Body::step is kick-then-drift (leapfrog), so a body's velocity is half a step behind its
+// position. Clusters are brought level with a half kick before sub-stepping and put back behind
+// after it (using the final sub-step's force), otherwise each step costs O(dt) in energy.
+class EncounterIntegrator {
+ public:
+  // Force on a due to b from the fields that are sub-stepped, dist_vec is from a to b
+  using PairForce = std::function<Vector2f(const Body&, const Body&, const Vector2f& dist_vec)>;
+
+  // Rate to flag candidates at in the force pass (fields::ClosePairs) for a step of dt
+  static float candidate_rate(const float dt);
+
+  // A pair is close when dt is more than ENCOUNTER_ETA of its dynamical time
+  // sqrt(distance^3 / strength) and they aren't touching. Only candidates (body index pairs,
+  // in any order and possibly repeated) are tested, instead of every pair again. Sleeping bodies
+  // are ignored, and so is charge if not include_charge. Clusters of more than
+  // ENCOUNTER_MAX_CLUSTER bodies are dropped.
+  void find(const std::vector<Body>& bodies, const fields::AttributeIndex& index,
+            const Boundary& boundary, const float dt, const bool include_charge,
+            std::vector<std::pair<size_t, size_t>> candidates);
+  bool contains(const size_t i) const { return i < cluster_of_.size() && cluster_of_[i] != NONE; }
+  size_t count_pairs() const { return pairs_.size(); }
+
+  // Advance every cluster by dt. Bodies' forces must hold the full force from the last force pass.
+  void integrate(std::vector<Body>& bodies, const Boundary& boundary, const float dt,
+                 const PairForce& pair_force) const;
+
+ private:
+  static constexpr size_t NONE = static_cast<size_t>(-1);
+
+  struct Member {
+    size_t body;
+    float mass;
+    float charge;      // 0 when charge isn't sub-stepped
+    bool gravity;
+  };
+  struct Pair {
+    size_t a, b;       // Into members_
+  };
+
+  // Pair strength: relative acceleration * distance^2
+  float strength(const Member& a, const Member& b) const;
+  void integrate_cluster(std::vector<Body>& bodies, const Boundary& boundary, const float dt,
+                         const PairForce& pair_force, const std::vector<size_t>& cluster) const;
+
+  std::vector<Member> members_;                 // Bodies with gravity or charge
+  std::vector<Pair> pairs_;                     // Close pairs
+  std::vector<size_t> cluster_of_;              // Per body, NONE if not in an encounter
+  std::vector<std::vector<size_t>> clusters_;   // Members of each cluster, indices into members_
+};
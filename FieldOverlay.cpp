@@ -0,0 +1,141 @@
+#include "FieldOverlay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "common.h"
+
+const char* overlay_mode_name(const eOverlayMode mode) {
+  switch (mode) {
+    case eNoOverlay:        return "off";
+    case eGravityArrows:    return "gravity field";
+    case eGravityPotential: return "gravity potential";
+    case eChargeArrows:     return "electric field";
+    case eChargePotential:  return "electric potential";
+    default:                return "NOT A MODE";
+  }
+}
+
+FieldOverlay::FieldOverlay(const sf::Vector2u target_size) :
+  probe_count_(std::max(1u, target_size.x / OVERLAY_SPACING),
+               std::max(1u, target_size.y / OVERLAY_SPACING)),
+  arrows_(sf::PrimitiveType::Lines),
+  heat_pixels_(probe_count_.x * probe_count_.y * 4)
+{
+  if (!heat_texture_.resize(probe_count_)) {
+    throw std::runtime_error("Failed to create overlay texture.");
+  }
+  heat_texture_.setSmooth(true);
+}
+
+void FieldOverlay::next_mode() {
+  mode_ = static_cast<eOverlayMode>((mode_ + 1) % eOverlayModeCount);
+  valid_ = false;
+}
+
+void FieldOverlay::draw(sf::RenderTarget& target, const Simulation& sim) {
+  if (mode_ == eNoOverlay) return;
+
+  const sf::View& view = target.getView();
+  if (needs_refresh(view, sim.get_bodies())) refresh(view, sim);
+
+  if (mode_ == eGravityArrows || mode_ == eChargeArrows) {
+    target.draw(arrows_);
+  } else {
+    sf::Sprite sprite(heat_texture_);
+    sprite.setPosition(sampled_centre_ - sampled_size_ / 2.f);
+    sprite.setScale({sampled_size_.x / static_cast<float>(probe_count_.x),
+                     sampled_size_.y / static_cast<float>(probe_count_.y)});
+    target.draw(sprite);
+  }
+}
+
+bool FieldOverlay::needs_refresh(const sf::View& view, const std::vector<Body>& bodies) const {
+  if (!valid_) return true;
+  if (view.getCenter() != sampled_centre_ || view.getSize() != sampled_size_) return true;
+  if (bodies.size() != sampled_positions_.size()) return true;
+
+  // Threshold is in screen pixels, so it follows the zoom
+  const float world_per_pixel = view.getSize().x / static_cast<float>(probe_count_.x * OVERLAY_SPACING);
+  const float threshold = OVERLAY_REFRESH_PIXELS * world_per_pixel;
+  const float threshold_sqr = threshold * threshold;
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    if ((bodies[i].get_position() - sampled_positions_[i]).squaredNorm() > threshold_sqr) return true;
+  }
+  return false;
+}
+
+void FieldOverlay::refresh(const sf::View& view, const Simulation& sim) {
+  sampled_centre_ = view.getCenter();
+  sampled_size_ = view.getSize();
+  const sf::Vector2f top_left = sampled_centre_ - sampled_size_ / 2.f;
+  const Vector2f spacing(sampled_size_.x / static_cast<float>(probe_count_.x),
+                         sampled_size_.y / static_cast<float>(probe_count_.y));
+
+  // Probe at the middle of each overlay cell
+  probes_.clear();
+  for (unsigned j = 0; j < probe_count_.y; ++j) {
+    for (unsigned i = 0; i < probe_count_.x; ++i) {
+      probes_.emplace_back(top_left.x + (static_cast<float>(i) + 0.5f) * spacing.x(),
+                           top_left.y + (static_cast<float>(j) + 0.5f) * spacing.y());
+    }
+  }
+
+  if (mode_ == eGravityArrows || mode_ == eGravityPotential) {
+    sim.sample_gravity(probes_, samples_);
+  } else {
+    sim.sample_charge(probes_, samples_);
+  }
+
+  if (mode_ == eGravityArrows || mode_ == eChargeArrows) {
+    build_arrows(std::min(spacing.x(), spacing.y()));
+  } else {
+    build_heat_map();
+  }
+
+  sampled_positions_.clear();
+  for (const auto& body : sim.get_bodies()) sampled_positions_.push_back(body.get_position());
+  valid_ = true;
+}
+
+void FieldOverlay::build_arrows(const float spacing) {
+  float max_magnitude = 0.0;
+  for (const auto& sample : samples_) max_magnitude = std::max(max_magnitude, sample.field.norm());
+
+  arrows_.clear();
+  if (max_magnitude == 0.0f) return;
+
+  for (size_t p = 0; p < probes_.size(); ++p) {
+    const float magnitude = samples_[p].field.norm();
+    if (magnitude == 0.0f) continue;
+
+    // sqrt so weak regions are still visible next to strong ones
+    const float strength = std::sqrt(magnitude / max_magnitude);
+    const Vector2f half = samples_[p].field / magnitude * (0.45f * spacing * strength);
+    const Vector2f tail = probes_[p] - half;
+    const Vector2f head = probes_[p] + half;
+
+    // Fade from tail to head to show direction
+    const uint8_t alpha = static_cast<uint8_t>(80.0f + 175.0f * strength);
+    arrows_.append(sf::Vertex{{tail.x(), tail.y()}, sf::Color(0, 80, 0, alpha)});
+    arrows_.append(sf::Vertex{{head.x(), head.y()}, sf::Color(120, 255, 120, alpha)});
+  }
+}
+
+void FieldOverlay::build_heat_map() {
+  float max_potential = 0.0;
+  for (const auto& sample : samples_) max_potential = std::max(max_potential, std::abs(sample.potential));
+
+  for (size_t p = 0; p < samples_.size(); ++p) {
+    // Signed sqrt, red for positive and blue for negative potential
+    const float v = max_potential > 0.0f ? samples_[p].potential / max_potential : 0.0f;
+    const float level = std::sqrt(std::abs(v));
+    heat_pixels_[p*4 + 0] = v > 0.0f ? static_cast<uint8_t>(255.0f * level) : 0;
+    heat_pixels_[p*4 + 1] = 0;
+    heat_pixels_[p*4 + 2] = v < 0.0f ? static_cast<uint8_t>(255.0f * level) : 0;
+    heat_pixels_[p*4 + 3] = static_cast<uint8_t>(160.0f * level);
+  }
+  heat_texture_.update(heat_pixels_.data());
+}
+
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+#include <Eigen/Dense>
+
+#include "Simulation.h"
+#include "Fields/Field.h"
+
+using Eigen::Vector2f;
+
+enum eOverlayMode {
+  eNoOverlay,
+  eGravityArrows,
+  eGravityPotential,
+  eChargeArrows,
+  eChargePotential,
+  eOverlayModeCount,  // Keep last
+};
+
+const char* overlay_mode_name(const eOverlayMode mode);
+
+// Field arrows or a potential heat map over the whole view, from a grid of probes.
+// Samples are cached and only recomputed when the view changes or a body has moved more than
+// OVERLAY_REFRESH_PIXELS on screen.
+class FieldOverlay {
+ public:
+  FieldOverlay(const sf::Vector2u target_size);
+
+  eOverlayMode get_mode() const { return mode_; }
+  void next_mode();
+
+  void draw(sf::RenderTarget& target, const Simulation& sim);
+
+ private:
+  bool needs_refresh(const sf::View& view, const std::vector<Body>& bodies) const;
+  void refresh(const sf::View& view, const Simulation& sim);
+  void build_arrows(const float spacing);
+  void build_heat_map();
+
+  eOverlayMode mode_ = eNoOverlay;
+  sf::Vector2u probe_count_;
+
+  std::vector<Vector2f> probes_;
+  std::vector<fields::FieldSample> samples_;
+
+  // State at the last refresh
+  bool valid_ = false;
+  sf::Vector2f sampled_centre_;
+  sf::Vector2f sampled_size_;
+  std::vector<Vector2f> sampled_positions_;
+
+  sf::VertexArray arrows_;
+  std::vector<uint8_t> heat_pixels_;
+  sf::Texture heat_texture_;
+};
+
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "../Body.h"
+#include "AttributeType.h"
+
+namespace fields {
+
+// Dense lists of which bodies carry each attribute type, so a field only visits its own
+// participants and a sparse attribute costs in proportion to its own population.
+class AttributeIndex {
+ public:
+  // Add the body at index in the body vector
+  void add(const Body& body, const size_t index) {
+    for (const eAttributeType type : body.get_attribute_types()) {
+      members_[type].push_back(index);
+    }
+  }
+
+  void rebuild(const std::vector<Body>& bodies) {
+    clear();
+    for (size_t i = 0; i < bodies.size(); ++i) {
+      add(bodies[i], i);
+    }
+  }
+
+  void clear() {
+    for (auto& list : members_) list.clear();
+  }
+
+  const std::vector<size_t>& members_of(const eAttributeType type) const { return members_[type]; }
+
+  template<typename Attr>
+  const std::vector<size_t>& members() const { return members_of(Attr::attr_type); }
+
+ private:
+  std::array<std::vector<size_t>, eAttributeTypeCount> members_;
+};
+
+}  // namespace fields
+
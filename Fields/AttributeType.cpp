@@ -5,6 +5,7 @@ void print_attr_type(std::ostream& os, eAttributeType t) {
     PRINT_EATTR(eNoAttribute)
     PRINT_EATTR(eGravityType)
     PRINT_EATTR(eChargeType)
+    PRINT_EATTR(eScreenedChargeType)
     default:
       os << "NOT A TYPE" << std::endl;
       break;
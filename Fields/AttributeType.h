@@ -7,6 +7,8 @@ enum eAttributeType {
   eNoAttribute,
   eGravityType,
   eChargeType,
+  eScreenedChargeType,
+  eAttributeTypeCount,  // Keep last
 };
 
 #define PRINT_EATTR(EATTR) \
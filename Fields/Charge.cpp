@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include <Eigen/Dense>
 
 #include "../common.h"
@@ -7,13 +9,15 @@ namespace fields {
 
 using Eigen::Vector2f;
 
-Charge::Charge() :
-  Field([](const Body& a, const Body& b,
-           const ChargeAttribute& ch_a, const ChargeAttribute& ch_b) -> Vector2f
+Charge::Charge(const float softening) :
+  Field([eps2 = softening * softening](const Body&, const Body&, const Vector2f& dist_vec,
+                                       const ChargeAttribute& ch_a, const ChargeAttribute& ch_b, float* potential) -> Vector2f
         {
-          const Vector2f dist_vec = a.displacement_to(b);
-          const float distance = dist_vec.norm();
-          return dist_vec * ch_a.get_charge() * -ch_b.get_charge() * COULOMB / (distance * distance * distance);
+          const float distance2 = dist_vec.squaredNorm() + eps2;   // Plummer softened
+          const float distance = std::sqrt(distance2);
+          const float kqq = COULOMB * ch_a.get_charge() * ch_b.get_charge();
+          if (potential) *potential = kqq / distance;
+          return dist_vec * -kqq / (distance2 * distance);
         })
 {}
 
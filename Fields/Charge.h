@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../common.h"
 #include "Field.h"
 #include "ChargeAttribute.h"
 
@@ -7,7 +8,16 @@ namespace fields {
 
 class Charge : public Field<ChargeAttribute> {
  public:
-  Charge();
+  // softening is the Plummer length, 0 for a bare 1/d^2 force
+  Charge(const float softening = CHARGE_SOFTENING);
+
+  using Field::sample;
+  // Field and potential for a unit charge at each probe
+  void sample(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+              const Boundary& boundary, const std::vector<Vector2f>& probes,
+              std::vector<FieldSample>& out) const {
+    sample(bodies, members, boundary, probes, ChargeAttribute(1.0f), out);
+  }
 };
 
 }  // namespace fields
@@ -0,0 +1,194 @@
+#include <cmath>
+#include <Eigen/Dense>
+
+#include "../common.h"
+#include "../tools.h"
+#include "EwaldCharge.h"
+
+namespace fields {
+
+using Eigen::Vector2f;
+
+namespace {
+
+// Cubic B-spline weights over the 4 mesh points from floor(u) - 1, for a point at u (mesh units)
+struct SplineWeights {
+  int first;
+  float w[4];
+
+  SplineWeights(const float u) {
+    const float base = std::floor(u);
+    const float t = u - base;
+    first = static_cast<int>(base) - 1;
+    w[0] = (1.0f - t) * (1.0f - t) * (1.0f - t) / 6.0f;
+    w[1] = (3.0f*t*t*t - 6.0f*t*t + 4.0f) / 6.0f;
+    w[2] = (-3.0f*t*t*t + 3.0f*t*t + 3.0f*t + 1.0f) / 6.0f;
+    w[3] = t * t * t / 6.0f;
+  }
+};
+
+inline size_t wrap_index(const int i) {
+  const int m = static_cast<int>(PME_MESH_SIZE);
+  return static_cast<size_t>(((i % m) + m) % m);
+}
+
+inline float sinc(const float x) {
+  return x == 0.0f ? 1.0f : std::sin(x) / x;
+}
+
+}  // namespace
+
+EwaldCharge::EwaldCharge() :
+  real_space_([](const Body&, const Body&, const Vector2f& dist_vec,
+                 const ChargeAttribute& ch_a, const ChargeAttribute& ch_b, float* potential) -> Vector2f
+              {
+                const float distance = dist_vec.norm();
+                if (distance > EWALD_CUTOFF) {
+                  if (potential) *potential = 0.0;
+                  return Vector2f::Zero();
+                }
+
+                // -d/dr of erfc(alpha r)/r
+                const float ar = EWALD_ALPHA * distance;
+                if (potential) *potential = COULOMB * ch_a.get_charge() * ch_b.get_charge() * std::erfc(ar) / distance;
+                const float magnitude = std::erfc(ar) / (distance * distance) +
+                                        2.0f * EWALD_ALPHA / std::sqrt(static_cast<float>(M_PI)) *
+                                          std::exp(-ar * ar) / distance;
+                return dist_vec * ch_a.get_charge() * -ch_b.get_charge() * COULOMB * magnitude / distance;
+              },
+              EWALD_CUTOFF, VERLET_SKIN),
+  density_(PME_MESH_SIZE * PME_MESH_SIZE),
+  field_x_(PME_MESH_SIZE * PME_MESH_SIZE),
+  field_y_(PME_MESH_SIZE * PME_MESH_SIZE),
+  potential_(PME_MESH_SIZE * PME_MESH_SIZE)
+{}
+
+void EwaldCharge::apply_forces(std::vector<Body>& bodies, const std::vector<size_t>& members,
+                               const Boundary& boundary, double* potential) {
+  real_space_.apply_forces(bodies, members, boundary, potential);
+  apply_mesh_forces(bodies, members, boundary, potential);
+}
+
+void EwaldCharge::apply_mesh_forces(std::vector<Body>& bodies, const std::vector<size_t>& members,
+                                    const Boundary& boundary, double* potential) {
+  constexpr size_t M = PME_MESH_SIZE;
+  const Vector2f& box = boundary.get_size();
+  const Vector2f spacing = box / static_cast<float>(M);
+
+  // -- Spread charges onto the mesh --
+  std::fill(density_.begin(), density_.end(), std::complex<float>(0.0f, 0.0f));
+  for (const size_t i : members) {
+    const Body& body = bodies[i];
+    const float charge = body.get_attribute<ChargeAttribute>().get_charge();
+    const SplineWeights sx(body.get_position().x() / spacing.x());
+    const SplineWeights sy(body.get_position().y() / spacing.y());
+    for (int j = 0; j < 4; ++j) {
+      const size_t row = wrap_index(sy.first + j) * M;
+      for (int i = 0; i < 4; ++i) {
+        density_[row + wrap_index(sx.first + i)] += charge * sx.w[i] * sy.w[j];
+      }
+    }
+  }
+
+  // -- Solve for the field in k space --
+  tools::fft_2d(density_, M, M, false);
+
+  const float area = box.x() * box.y();
+  for (size_t ny = 0; ny < M; ++ny) {
+    const int sy = ny < M/2 ? static_cast<int>(ny) : static_cast<int>(ny) - static_cast<int>(M);
+    const float ky = 2.0f * M_PI * sy / box.y();
+    for (size_t nx = 0; nx < M; ++nx) {
+      const int sx = nx < M/2 ? static_cast<int>(nx) : static_cast<int>(nx) - static_cast<int>(M);
+      const float kx = 2.0f * M_PI * sx / box.x();
+      const size_t idx = ny * M + nx;
+
+      const float k = std::sqrt(kx*kx + ky*ky);
+      if (k == 0.0f) {   // Uniform neutralising background
+        field_x_[idx] = field_y_[idx] = potential_[idx] = 0.0f;
+        continue;
+      }
+
+      // In-plane transform of erf(alpha r)/r, divided by the spline's transform for both
+      // spreading and interpolation
+      const float spline = std::pow(sinc(0.5f * kx * spacing.x()) * sinc(0.5f * ky * spacing.y()), 4);
+      const float green = 2.0f * M_PI * std::erfc(k / (2.0f * EWALD_ALPHA)) / (k * area * spline * spline);
+      potential_[idx] = density_[idx] * green;
+
+      // Gradient, the Nyquist frequency has no well defined derivative
+      const std::complex<float> i_unit(0.0f, 1.0f);
+      field_x_[idx] = (nx == M/2) ? 0.0f : i_unit * kx * potential_[idx];
+      field_y_[idx] = (ny == M/2) ? 0.0f : i_unit * ky * potential_[idx];
+    }
+  }
+
+  tools::fft_2d(field_x_, M, M, true);
+  tools::fft_2d(field_y_, M, M, true);
+  tools::fft_2d(potential_, M, M, true);   // Kept for sample()
+  has_mesh_ = true;
+
+  // -- Interpolate the potential gradient back to the bodies --
+  double mesh_energy = 0.0;
+  double charge_sqr_sum = 0.0;
+  for (const size_t i : members) {
+    Body& body = bodies[i];
+    const float charge = body.get_attribute<ChargeAttribute>().get_charge();
+    const SplineWeights sx(body.get_position().x() / spacing.x());
+    const SplineWeights sy(body.get_position().y() / spacing.y());
+
+    Vector2f gradient = Vector2f::Zero();
+    float mesh_potential = 0.0;
+    for (int j = 0; j < 4; ++j) {
+      const size_t row = wrap_index(sy.first + j) * M;
+      for (int i = 0; i < 4; ++i) {
+        const size_t idx = row + wrap_index(sx.first + i);
+        const float w = sx.w[i] * sy.w[j];
+        gradient += w * Vector2f(field_x_[idx].real(), field_y_[idx].real());
+        mesh_potential += w * potential_[idx].real();
+      }
+    }
+    body.apply_force(-COULOMB * charge * gradient);
+
+    mesh_energy += 0.5 * COULOMB * charge * mesh_potential;
+    charge_sqr_sum += charge * charge;
+  }
+
+  if (potential) {
+    // The mesh part includes each charge's interaction with its own smoothed cloud
+    const double self_energy = COULOMB * EWALD_ALPHA / std::sqrt(M_PI) * charge_sqr_sum;
+    *potential += mesh_energy - self_energy;
+  }
+}
+
+void EwaldCharge::sample(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+                         const Boundary& boundary, const std::vector<Vector2f>& probes,
+                         std::vector<FieldSample>& out) const {
+  // Short range part directly, it is zero past the cutoff
+  real_space_.sample(bodies, members, boundary, probes, ChargeAttribute(1.0f), out);
+  if (!has_mesh_) return;
+
+  constexpr size_t M = PME_MESH_SIZE;
+  const Vector2f spacing = boundary.get_size() / static_cast<float>(M);
+
+  #pragma omp parallel for schedule(static)
+  for (size_t p = 0; p < probes.size(); ++p) {
+    const SplineWeights sx(probes[p].x() / spacing.x());
+    const SplineWeights sy(probes[p].y() / spacing.y());
+
+    Vector2f gradient = Vector2f::Zero();
+    float mesh_potential = 0.0;
+    for (int j = 0; j < 4; ++j) {
+      const size_t row = wrap_index(sy.first + j) * M;
+      for (int i = 0; i < 4; ++i) {
+        const size_t idx = row + wrap_index(sx.first + i);
+        const float w = sx.w[i] * sy.w[j];
+        gradient += w * Vector2f(field_x_[idx].real(), field_y_[idx].real());
+        mesh_potential += w * potential_[idx].real();
+      }
+    }
+    out[p].field += -COULOMB * gradient;
+    out[p].potential += COULOMB * mesh_potential;
+  }
+}
+
+}  // namespace fields
+
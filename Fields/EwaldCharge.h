@@ -0,0 +1,47 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "../Body.h"
+#include "../Boundary.h"
+#include "ShortRangeField.h"
+#include "ChargeAttribute.h"
+
+namespace fields {
+
+// Charge in a periodic box, summed over every periodic image. Split (Ewald) into a short
+// range erfc part using neighbour lists, and a smooth long range part solved on a mesh with
+// FFTs (particle-mesh Ewald), so the cost is O(N log N) rather than a sum over image boxes.
+// Uses the same ChargeAttribute as Charge.
+class EwaldCharge {
+ public:
+  EwaldCharge();
+
+  // members are the indices of bodies with a ChargeAttribute.
+  // Adds the total potential energy to potential if given.
+  void apply_forces(std::vector<Body>& bodies, const std::vector<size_t>& members,
+                    const Boundary& boundary, double* potential = nullptr);
+  void invalidate() { real_space_.invalidate(); }
+
+  // Field and potential for a unit charge at each probe. The smooth part is interpolated from
+  // the mesh solved in the last apply_forces, so call this after a step.
+  void sample(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+              const Boundary& boundary, const std::vector<Vector2f>& probes,
+              std::vector<FieldSample>& out) const;
+
+ private:
+  void apply_mesh_forces(std::vector<Body>& bodies, const std::vector<size_t>& members,
+                         const Boundary& boundary, double* potential);
+
+  ShortRangeField<ChargeAttribute> real_space_;
+
+  std::vector<std::complex<float>> density_;
+  std::vector<std::complex<float>> field_x_;
+  std::vector<std::complex<float>> field_y_;
+  std::vector<std::complex<float>> potential_;
+  bool has_mesh_ = false;
+};
+
+}  // namespace fields
+
@@ -1,33 +1,131 @@
 #pragma once
 
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include <Eigen/Dense>
 #include "../Body.h"
+#include "../Boundary.h"
 
 namespace fields {
 
+// Pairs a force pass found to be changing fast: relative acceleration / distance above rate
+// (1 / time^2). Candidates for EncounterIntegrator, appended to by every pass given one.
+struct ClosePairs {
+  float rate = 0.0;
+  std::vector<std::pair<size_t, size_t>> pairs;
+
+  // From the force the pass has just computed, without a sqrt
+  void test(const Body& a, const Body& b, const size_t i, const size_t j,
+            const Vector2f& dist_vec, const Vector2f& force) {
+    const float inv_mass = 1.0f / a.get_mass() + 1.0f / b.get_mass();
+    if (force.squaredNorm() * inv_mass * inv_mass > rate * rate * dist_vec.squaredNorm()) {
+      pairs.emplace_back(i, j);
+    }
+  }
+};
+
+// What a field looks like at a point: force on, and potential energy of, a unit probe
+struct FieldSample {
+  Vector2f field = Vector2f::Zero();
+  float potential = 0.0;
+};
+
 template<typename Attr>
 class Field {
  public:
-  Field(std::function<Vector2f(const Body&, const Body&, const Attr&, const Attr&)> force_func) :
+  // Force on a due to b. dist_vec is the displacement from a to b.
+  // If potential is not null, the pair's potential energy is also written to it.
+  using ForceFunc = std::function<Vector2f(const Body&, const Body&, const Vector2f&,
+                                           const Attr&, const Attr&, float* potential)>;
+
+  Field(ForceFunc force_func) :
     force_func_(force_func)
   {}
 
   void apply_force(Body& a, Body& b) const {
+    apply_force(a, b, a.displacement_to(b));
+  }
+
+  // For when the displacement is not simply b - a (e.g nearest periodic image)
+  void apply_force(Body& a, Body& b, const Vector2f& dist_vec) const {
     // If one of the bodies does not have a field component, exit
     if (!(a.has_attribute<Attr>() && b.has_attribute<Attr>()))
       return;
 
     const auto attribute_a = a.get_attribute<Attr>();
     const auto attribute_b = b.get_attribute<Attr>();
-    const Vector2f force = force_func_(a, b, attribute_a, attribute_b);
+    const Vector2f force = force_func_(a, b, dist_vec, attribute_a, attribute_b, nullptr);
     // Apply force between bodies
     a.apply_force(force);
     b.apply_force(-force);
   }
 
- private:
-  std::function<Vector2f(const Body&, const Body&, const Attr&, const Attr&)> force_func_;
+  const ForceFunc& get_force_func() const { return force_func_; }
+
+  // Force on a due to b without applying it, zero if either lacks Attr
+  Vector2f pair_force(const Body& a, const Body& b, const Vector2f& dist_vec) const {
+    if (!(a.has_attribute<Attr>() && b.has_attribute<Attr>())) return Vector2f::Zero();
+    return force_func_(a, b, dist_vec, a.get_attribute<Attr>(), b.get_attribute<Attr>(), nullptr);
+  }
+
+  // Apply between every pair of members, which are indices of bodies that have Attr.
+  // Adds the total potential energy to potential if given, and fast changing pairs to close.
+  void apply_forces(std::vector<Body>& bodies, const std::vector<size_t>& members,
+                    const Boundary& boundary, double* potential = nullptr,
+                    ClosePairs* close = nullptr) const {
+    if (members.size() < 2) return;
+
+    float pair_potential = 0.0;
+    double total_potential = 0.0;
+
+    for (size_t m = 0; m < members.size()-1; ++m) {
+      Body& a = bodies[members[m]];
+      const Attr& attribute_a = a.get_attribute<Attr>();
+      for (size_t n = m+1; n < members.size(); ++n) {
+        Body& b = bodies[members[n]];
+        const Vector2f dist_vec = boundary.displacement(a.get_position(), b.get_position());
+        const Vector2f force = force_func_(a, b, dist_vec, attribute_a, b.get_attribute<Attr>(),
+                                           potential ? &pair_potential : nullptr);
+        a.apply_force(force);
+        b.apply_force(-force);
+        total_potential += pair_potential;
+        if (close) close->test(a, b, members[m], members[n], dist_vec, force);
+      }
+    }
+    if (potential) *potential += total_potential;
+  }
+
+  // Field and potential at each probe point due to every member, as felt by a unit mass probe
+  // carrying probe_attribute. Sources closer than their own radius are skipped (the field inside
+  // a body isn't modelled). Probes are independent, so they are split across threads.
+  void sample(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+              const Boundary& boundary, const std::vector<Vector2f>& probes,
+              const Attr& probe_attribute, std::vector<FieldSample>& out) const {
+    out.assign(probes.size(), FieldSample());
+
+    #pragma omp parallel for schedule(static)
+    for (size_t p = 0; p < probes.size(); ++p) {
+      const Body probe(probes[p], Vector2f::Zero(), 0.0f, 1.0f);
+      FieldSample sample;
+      float pair_potential = 0.0;
+
+      for (const size_t i : members) {
+        const Body& source = bodies[i];
+        const Vector2f dist_vec = boundary.displacement(probes[p], source.get_position());
+        if (dist_vec.squaredNorm() < source.get_radius() * source.get_radius()) continue;
+
+        sample.field += force_func_(probe, source, dist_vec, probe_attribute,
+                                    source.get_attribute<Attr>(), &pair_potential);
+        sample.potential += pair_potential;
+      }
+      out[p] = sample;
+    }
+  }
+
+ protected:
+  ForceFunc force_func_;
 };
 
 }  // namespace fields
-
@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include <Eigen/Dense>
 
 #include "../common.h"
@@ -7,13 +9,16 @@ namespace fields {
 
 using Eigen::Vector2f;
 
-Gravity::Gravity() :
-  Field([](const Body& a, const Body& b,
-           const GravityAttribute&, const GravityAttribute&) -> Vector2f
+Gravity::Gravity(const float softening) :
+  Field([eps2 = softening * softening](const Body& a, const Body& b, const Vector2f& dist_vec,
+                                       const GravityAttribute&, const GravityAttribute&, float* potential) -> Vector2f
         {
-          Vector2f force = a.displacement_to(b);
-          const float distance = force.norm();
-          force *= G * a.get_mass() * b.get_mass() / (distance*distance*distance);
+          Vector2f force = dist_vec;
+          const float distance2 = force.squaredNorm() + eps2;   // Plummer softened
+          const float distance = std::sqrt(distance2);
+          const float gmm = G * a.get_mass() * b.get_mass();
+          force *= gmm / (distance2*distance);
+          if (potential) *potential = -gmm / distance;
           return force; 
         })
 {}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../common.h"
 #include "Field.h"
 #include "GravityAttribute.h"
 
@@ -7,7 +8,16 @@ namespace fields {
 
 class Gravity : public Field<GravityAttribute> {
  public:
-  Gravity();
+  // softening is the Plummer length, 0 for a bare 1/d^2 force
+  Gravity(const float softening = GRAVITY_SOFTENING);
+
+  using Field::sample;
+  // Field and potential for a unit mass at each probe
+  void sample(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+              const Boundary& boundary, const std::vector<Vector2f>& probes,
+              std::vector<FieldSample>& out) const {
+    sample(bodies, members, boundary, probes, GravityAttribute(), out);
+  }
 };
 
 }  // namespace fields
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cmath>
+
+#include <Eigen/Dense>
+#include "../common.h"
+#include "ShortRangeField.h"
+
+namespace fields {
+
+// The short range part of another field, for multiple time stepping: its force times a switch
+// that is 1 up to switch_start and falls smoothly to 0 at switch_end. The rest of the field
+// (full minus near) changes slowly, so it can be applied less often.
+template<typename Attr>
+class NearField : public ShortRangeField<Attr> {
+ public:
+  NearField(const Field<Attr>& full, const float switch_start, const float switch_end) :
+    ShortRangeField<Attr>(switched(full.get_force_func(), switch_start, switch_end),
+                          switch_end, VERLET_SKIN)
+  {}
+
+ private:
+  static typename Field<Attr>::ForceFunc switched(const typename Field<Attr>::ForceFunc& force_func,
+                                                  const float start, const float end) {
+    return [=](const Body& a, const Body& b, const Vector2f& dist_vec,
+               const Attr& attr_a, const Attr& attr_b, float* potential) -> Vector2f {
+      if (potential) *potential = 0.0;   // Energy comes from the full field
+      const float distance = dist_vec.norm();
+      if (distance >= end) return Vector2f::Zero();
+      const Vector2f force = force_func(a, b, dist_vec, attr_a, attr_b, nullptr);
+      if (distance <= start) return force;
+      // Smoothstep from 1 down to 0
+      const float x = (distance - start) / (end - start);
+      return force * (1.0f - x * x * (3.0f - 2.0f * x));
+    };
+  }
+};
+
+}  // namespace fields
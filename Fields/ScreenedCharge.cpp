@@ -0,0 +1,34 @@
+#include <cmath>
+#include <Eigen/Dense>
+
+#include "../common.h"
+#include "ScreenedCharge.h"
+
+namespace fields {
+
+using Eigen::Vector2f;
+
+ScreenedCharge::ScreenedCharge() :
+  ShortRangeField([](const Body&, const Body&, const Vector2f& dist_vec,
+                     const ScreenedChargeAttribute& ch_a,
+                     const ScreenedChargeAttribute& ch_b, float* potential) -> Vector2f
+                  {
+                    const float distance = dist_vec.norm();
+                    if (distance > SCREENED_CUTOFF) {
+                      if (potential) *potential = 0.0;
+                      return Vector2f::Zero();
+                    }
+
+                    // -dU/dr of U = kq_aq_b exp(-r/l)/r, along the unit vector from a to b
+                    const float screened_kqq = ch_a.get_charge() * ch_b.get_charge() * SCREENED_COULOMB *
+                                               std::exp(-distance / DEBYE_LENGTH);
+                    if (potential) *potential = screened_kqq / distance;
+                    const float magnitude = -screened_kqq *
+                                            (1.0f / (distance * distance) + 1.0f / (DEBYE_LENGTH * distance));
+                    return dist_vec * magnitude / distance;
+                  },
+                  SCREENED_CUTOFF, VERLET_SKIN)
+{}
+
+}  // fields
+
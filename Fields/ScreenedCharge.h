@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ShortRangeField.h"
+#include "ScreenedChargeAttribute.h"
+
+namespace fields {
+
+// Yukawa/Debye-screened charge. Falls off as exp(-r/DEBYE_LENGTH)/r, and is cut off
+// completely at SCREENED_CUTOFF.
+class ScreenedCharge : public ShortRangeField<ScreenedChargeAttribute> {
+ public:
+  ScreenedCharge();
+};
+
+}  // namespace fields
+
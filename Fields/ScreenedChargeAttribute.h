@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Attribute.h"
+
+namespace fields {
+
+class ScreenedChargeAttribute : public Attribute {
+ public:
+  DEFINE_ATTRIBUTE_TYPE(ScreenedCharge)
+
+  ScreenedChargeAttribute(const float charge) : charge_(charge) {}
+  ScreenedChargeAttribute(const ScreenedChargeAttribute& other) : charge_(other.charge_) {}
+
+  float get_charge() const { return charge_; }
+
+ private:
+  float charge_;
+};
+
+}  // namespace fields
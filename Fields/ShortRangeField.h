@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+#include "../Body.h"
+#include "../Boundary.h"
+#include "Field.h"
+
+namespace fields {
+
+// A field with a finite range. Instead of visiting every pair, keeps a Verlet
+// neighbour list of pairs within (cutoff + skin), which is only rebuilt once some
+// body has moved more than half of the skin since the last build.
+template<typename Attr>
+class ShortRangeField : public Field<Attr> {
+ public:
+  ShortRangeField(typename Field<Attr>::ForceFunc force_func, const float cutoff, const float skin) :
+    Field<Attr>(force_func), cutoff_(cutoff), skin_(skin)
+  {}
+
+  // Apply the field between all neighbouring pairs of members (indices of bodies that have Attr).
+  // Adds the total potential energy to potential if given, and fast changing pairs to close.
+  void apply_forces(std::vector<Body>& bodies, const std::vector<size_t>& members,
+                    const Boundary& boundary, double* potential = nullptr,
+                    ClosePairs* close = nullptr) {
+    if (needs_rebuild(bodies, members, boundary)) rebuild(bodies, members, boundary);
+
+    float pair_potential = 0.0;
+    double total_potential = 0.0;
+
+    for (const auto& [i, j] : neighbours_) {
+      Body& a = bodies[i];
+      Body& b = bodies[j];
+      const Vector2f dist_vec = boundary.displacement(a.get_position(), b.get_position());
+      const Vector2f force = this->force_func_(a, b, dist_vec,
+                                               a.template get_attribute<Attr>(),
+                                               b.template get_attribute<Attr>(),
+                                               potential ? &pair_potential : nullptr);
+      a.apply_force(force);
+      b.apply_force(-force);
+      total_potential += pair_potential;
+      if (close) close->test(a, b, i, j, dist_vec, force);
+    }
+    if (potential) *potential += total_potential;
+  }
+
+  // As Field::sample, but each probe only visits members in the 3x3 block of cells around it,
+  // reusing the grid of the last rebuild. Visits every member if the list is out of date.
+  void sample(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+              const Boundary& boundary, const std::vector<Vector2f>& probes,
+              const Attr& probe_attribute, std::vector<FieldSample>& out) const {
+    if (needs_rebuild(bodies, members, boundary)) {
+      Field<Attr>::sample(bodies, members, boundary, probes, probe_attribute, out);
+      return;
+    }
+    out.assign(probes.size(), FieldSample());
+    const float cutoff_sqr = cutoff_ * cutoff_;
+
+    // Members have moved less than half the skin since binning, so everything within the
+    // cutoff of a probe is still in the block around it
+    #pragma omp parallel for schedule(static)
+    for (size_t p = 0; p < probes.size(); ++p) {
+      const Body probe(probes[p], Vector2f::Zero(), 0.0f, 1.0f);
+      FieldSample sample;
+      float pair_potential = 0.0;
+
+      int64_t around[9];
+      const size_t around_count = cells_around(cell_of(probes[p]), around);
+      for (size_t c = 0; c < around_count; ++c) {
+        const auto cell = cells_.find(around[c]);
+        if (cell == cells_.end()) continue;
+
+        for (const size_t m : cell->second) {
+          const Body& source = bodies[members[m]];
+          const Vector2f dist_vec = boundary.displacement(probes[p], source.get_position());
+          const float dist_sqr = dist_vec.squaredNorm();
+          if (dist_sqr < source.get_radius() * source.get_radius() || dist_sqr > cutoff_sqr) continue;
+
+          sample.field += this->force_func_(probe, source, dist_vec, probe_attribute,
+                                            source.template get_attribute<Attr>(), &pair_potential);
+          sample.potential += pair_potential;
+        }
+      }
+      out[p] = sample;
+    }
+  }
+
+  // Call when bodies have been added/removed/reordered, so the list is rebuilt next step.
+  void invalidate() { valid_ = false; }
+
+  float get_cutoff() const { return cutoff_; }
+
+ private:
+  bool needs_rebuild(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+                     const Boundary& boundary) const {
+    if (!valid_ || members != reference_members_) return true;
+    if (boundary.get_mode() != built_mode_) return true;
+
+    const float max_sqr = 0.25f * skin_ * skin_;
+    for (size_t m = 0; m < members.size(); ++m) {
+      if (boundary.displacement(reference_positions_[m], bodies[members[m]].get_position()).squaredNorm() > max_sqr) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Bin participating bodies into a grid of at least (cutoff + skin) sized cells, then only
+  // compare against the 3x3 block of cells around each body. In a periodic box the grid
+  // exactly tiles the box and wraps around.
+  void rebuild(const std::vector<Body>& bodies, const std::vector<size_t>& members,
+               const Boundary& boundary) {
+    const float list_radius = cutoff_ + skin_;
+    const float list_radius_sqr = list_radius * list_radius;
+    periodic_ = boundary.is_periodic();
+
+    cell_count_[0] = cell_count_[1] = 0;
+    cell_size_ = Vector2f(list_radius, list_radius);
+    if (periodic_) {
+      for (int d = 0; d < 2; ++d) {
+        cell_count_[d] = std::max(1, static_cast<int32_t>(boundary.get_size()[d] / list_radius));
+        cell_size_[d] = boundary.get_size()[d] / static_cast<float>(cell_count_[d]);
+      }
+    }
+
+    neighbours_.clear();
+    reference_members_ = members;
+    reference_positions_.resize(members.size());
+    built_mode_ = boundary.get_mode();
+    valid_ = true;
+    cells_.clear();
+
+    // Cells hold member slots, not body indices
+    for (size_t m = 0; m < members.size(); ++m) {
+      reference_positions_[m] = bodies[members[m]].get_position();
+      cells_[cell_of(reference_positions_[m])].push_back(m);
+    }
+
+    int64_t around[9];
+    for (const auto& [key, slots] : cells_) {
+      const size_t around_count = cells_around(key, around);
+      for (size_t c = 0; c < around_count; ++c) {
+        const auto other = cells_.find(around[c]);
+        if (other == cells_.end()) continue;
+
+        for (const size_t m : slots) {
+          for (const size_t n : other->second) {
+            if (n <= m) continue;   // Each pair only once
+            if (boundary.displacement(reference_positions_[m], reference_positions_[n]).squaredNorm() < list_radius_sqr) {
+              neighbours_.emplace_back(members[m], members[n]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  int64_t key_of(int32_t cx, int32_t cy) const {
+    if (periodic_) {
+      cx %= cell_count_[0];
+      cy %= cell_count_[1];
+      if (cx < 0) cx += cell_count_[0];
+      if (cy < 0) cy += cell_count_[1];
+    }
+    return (static_cast<int64_t>(cx) << 32) | static_cast<uint32_t>(cy);
+  }
+
+  int64_t cell_of(const Vector2f& position) const {
+    return key_of(static_cast<int32_t>(std::floor(position.x() / cell_size_.x())),
+                  static_cast<int32_t>(std::floor(position.y() / cell_size_.y())));
+  }
+
+  // Keys of the 3x3 block around a cell. With fewer than 3 cells across a periodic box the same
+  // cell can appear twice, so duplicates are left out. Returns how many were written.
+  size_t cells_around(const int64_t key, int64_t (&around)[9]) const {
+    const int32_t cx = static_cast<int32_t>(key >> 32);
+    const int32_t cy = static_cast<int32_t>(static_cast<uint32_t>(key));
+    size_t count = 0;
+    for (int32_t dx = -1; dx <= 1; ++dx) {
+      for (int32_t dy = -1; dy <= 1; ++dy) {
+        const int64_t other_key = key_of(cx + dx, cy + dy);
+        if (std::find(around, around + count, other_key) == around + count) around[count++] = other_key;
+      }
+    }
+    return count;
+  }
+
+  float cutoff_;
+  float skin_;
+
+  std::vector<std::pair<size_t, size_t>> neighbours_;
+  bool valid_ = false;
+  std::vector<size_t> reference_members_;       // Members at last rebuild
+  std::vector<Vector2f> reference_positions_;   // And their positions
+  eBoundaryMode built_mode_ = eOpenBoundary;
+  std::unordered_map<int64_t, std::vector<size_t>> cells_;
+  Vector2f cell_size_ = Vector2f::Zero();   // Grid of the last rebuild
+  int32_t cell_count_[2] = {0, 0};          // Cells across the box, when periodic
+  bool periodic_ = false;
+};
+
+}  // namespace fields
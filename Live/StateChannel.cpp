@@ -0,0 +1,211 @@
+#include "StateChannel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace live {
+
+namespace {
+
+constexpr size_t ALIGNMENT = 64;
+
+size_t align_up(const size_t bytes) {
+  return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+size_t buffer_bytes(const size_t capacity) {
+  return align_up(sizeof(BufferHeader) + capacity * (2 * sizeof(float) + sizeof(float) + sizeof(uint32_t)));
+}
+
+size_t segment_bytes(const size_t capacity) {
+  return align_up(sizeof(ChannelHeader)) + 2 * buffer_bytes(capacity);
+}
+
+// Arrays inside a buffer
+struct BufferView {
+  BufferHeader* header;
+  float* positions;
+  float* radii;
+  uint32_t* colors;
+};
+
+BufferView view_of(uint8_t* buffer, const size_t capacity) {
+  BufferView view;
+  view.header = reinterpret_cast<BufferHeader*>(buffer);
+  view.positions = reinterpret_cast<float*>(buffer + sizeof(BufferHeader));
+  view.radii = view.positions + 2 * capacity;
+  view.colors = reinterpret_cast<uint32_t*>(view.radii + capacity);
+  return view;
+}
+
+uint32_t pack(const sf::Color color) {
+  return (static_cast<uint32_t>(color.r) << 24) | (static_cast<uint32_t>(color.g) << 16) |
+         (static_cast<uint32_t>(color.b) << 8) | static_cast<uint32_t>(color.a);
+}
+
+}  // namespace
+
+// -- Mapping --
+
+Mapping::Mapping(Mapping&& other) noexcept :
+  address_(std::exchange(other.address_, nullptr)), size_(std::exchange(other.size_, 0))
+{}
+
+Mapping& Mapping::operator=(Mapping&& other) noexcept {
+  if (this != &other) {
+    if (address_) munmap(address_, size_);
+    address_ = std::exchange(other.address_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+Mapping::~Mapping() {
+  if (address_) munmap(address_, size_);
+}
+
+uint8_t* Mapping::buffer(const size_t index) const {
+  return static_cast<uint8_t*>(address_) + align_up(sizeof(ChannelHeader)) +
+         index * buffer_bytes(header().capacity);
+}
+
+// -- Publisher --
+
+Publisher::Publisher(const std::string& name, const uint32_t capacity) :
+  name_(name), capacity_(capacity)
+{
+  // Replace whatever a previous run left behind
+  shm_unlink(name_.c_str());
+  const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) throw std::runtime_error("Failed to create shared memory " + name_);
+
+  const size_t size = segment_bytes(capacity_);
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    shm_unlink(name_.c_str());
+    throw std::runtime_error("Failed to size shared memory " + name_);
+  }
+  void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    throw std::runtime_error("Failed to map shared memory " + name_);
+  }
+  mapping_ = Mapping(address, size);
+
+  // Readers ignore the segment until the magic is in place
+  ChannelHeader* header = new (address) ChannelHeader{};
+  header->version = ChannelHeader::VERSION;
+  header->session = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                    static_cast<uint64_t>(getpid());
+  header->capacity = capacity_;
+  header->sequence.store(0, std::memory_order_relaxed);
+  for (size_t b = 0; b < 2; ++b) {
+    new (mapping_.buffer(b)) BufferHeader{};
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = ChannelHeader::MAGIC;
+}
+
+Publisher::~Publisher() {
+  shm_unlink(name_.c_str());
+}
+
+void Publisher::publish(const std::vector<Body>& bodies, const uint64_t step, const double time) {
+  ChannelHeader& header = mapping_.header();
+  const uint64_t sequence = header.sequence.load(std::memory_order_relaxed) + 1;
+  const BufferView buffer = view_of(mapping_.buffer(sequence % 2), capacity_);
+
+  // Seqlock write: odd, fence, data, even
+  const uint64_t lock = buffer.header->lock.load(std::memory_order_relaxed);
+  buffer.header->lock.store(lock + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const size_t count = std::min<size_t>(bodies.size(), capacity_);
+  buffer.header->step = step;
+  buffer.header->time = time;
+  buffer.header->count = static_cast<uint32_t>(count);
+  buffer.header->truncated = bodies.size() > capacity_;
+  for (size_t i = 0; i < count; ++i) {
+    const Body& body = bodies[i];
+    buffer.positions[2*i] = body.get_position().x();
+    buffer.positions[2*i + 1] = body.get_position().y();
+    buffer.radii[i] = body.get_radius();
+    buffer.colors[i] = pack(body.get_color());
+  }
+
+  buffer.header->lock.store(lock + 2, std::memory_order_release);
+  header.sequence.store(sequence, std::memory_order_release);
+}
+
+// -- Reader --
+
+bool Reader::attach() {
+  const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0) return is_attached();   // Publisher gone, keep showing the last frame
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ChannelHeader)) {
+    close(fd);
+    return is_attached();
+  }
+  const size_t size = static_cast<size_t>(info.st_size);
+  void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) return is_attached();
+
+  Mapping mapping(address, size);
+  const ChannelHeader& header = mapping.header();
+  const bool valid = header.magic == ChannelHeader::MAGIC && header.version == ChannelHeader::VERSION &&
+                     size >= segment_bytes(header.capacity);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid) return is_attached();
+
+  if (!is_attached() || header.session != session_) {
+    session_ = header.session;
+    mapping_ = std::move(mapping);
+  }
+  return true;
+}
+
+bool Reader::read(Snapshot& out) const {
+  if (!is_attached()) return false;
+  const ChannelHeader& header = mapping_.header();
+
+  // A couple of tries, then give up until the next frame rather than spin
+  for (int attempt = 0; attempt < 4; ++attempt) {
+    const uint64_t sequence = header.sequence.load(std::memory_order_acquire);
+    if (sequence == 0 || (sequence == out.sequence && session_ == out.session)) return false;
+
+    const BufferView buffer = view_of(mapping_.buffer(sequence % 2), header.capacity);
+    const uint64_t lock = buffer.header->lock.load(std::memory_order_acquire);
+    if (lock & 1) continue;   // Lapped, the publisher is already reusing this buffer
+
+    const size_t count = std::min<size_t>(buffer.header->count, header.capacity);
+    out.step = buffer.header->step;
+    out.time = buffer.header->time;
+    out.truncated = buffer.header->truncated != 0;
+    out.positions.assign(buffer.positions, buffer.positions + 2 * count);
+    out.radii.assign(buffer.radii, buffer.radii + count);
+    out.colors.assign(buffer.colors, buffer.colors + count);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (buffer.header->lock.load(std::memory_order_relaxed) == lock) {
+      out.session = session_;
+      out.sequence = sequence;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace live
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../Body.h"
+
+namespace live {
+
+// Body state shared between a headless simulation and any number of viewers through a POSIX
+// shared memory segment. There are two buffers: the publisher always writes the one readers
+// weren't pointed at, then flips `sequence` to it. Each buffer also has a seqlock counter (odd
+// while being written) so a reader that is lapped by two publishes notices and retries.
+// Nobody ever waits on anyone else.
+struct ChannelHeader {
+  static constexpr uint32_t MAGIC = 0x4f524254;   // "ORBT"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint64_t session;                 // Changes when a new publisher creates the segment
+  uint32_t capacity;                // Bodies per buffer
+  uint32_t padding;
+  std::atomic<uint64_t> sequence;   // Publishes so far, the latest is in buffers[sequence % 2]
+};
+
+struct BufferHeader {
+  std::atomic<uint64_t> lock;       // Odd while being written
+  uint64_t step;
+  double time;
+  uint32_t count;
+  uint32_t truncated;               // More bodies than capacity, the rest were left out
+};
+
+// One frame as read by a viewer
+struct Snapshot {
+  uint64_t session = 0;
+  uint64_t sequence = 0;
+  uint64_t step = 0;
+  double time = 0.0;
+  bool truncated = false;
+  std::vector<float> positions;     // x, y per body
+  std::vector<float> radii;
+  std::vector<uint32_t> colors;     // 0xRRGGBBAA
+};
+
+// Shared memory mapping of a channel, owned by a Publisher or Reader
+class Mapping {
+ public:
+  Mapping() = default;
+  Mapping(void* address, const size_t size) : address_(address), size_(size) {}
+  Mapping(const Mapping&) = delete;
+  Mapping& operator=(const Mapping&) = delete;
+  Mapping(Mapping&& other) noexcept;
+  Mapping& operator=(Mapping&& other) noexcept;
+  ~Mapping();
+
+  bool is_mapped() const { return address_ != nullptr; }
+  ChannelHeader& header() const { return *static_cast<ChannelHeader*>(address_); }
+  // Start of buffer 0 or 1: BufferHeader, then positions, radii and colours for capacity bodies
+  uint8_t* buffer(const size_t index) const;
+
+ private:
+  void* address_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Creates the segment and writes into it, one copy of the bodies per publish.
+// Unlinks the segment when destroyed, viewers that are attached keep their mapping.
+class Publisher {
+ public:
+  Publisher(const std::string& name, const uint32_t capacity);
+  ~Publisher();
+
+  void publish(const std::vector<Body>& bodies, const uint64_t step, const double time);
+
+ private:
+  std::string name_;
+  Mapping mapping_;
+  uint32_t capacity_;
+};
+
+// Attaches to a segment if there is one. Never blocks the publisher.
+class Reader {
+ public:
+  explicit Reader(const std::string& name) : name_(name) {}
+
+  // Attach, or re-attach if a new publisher has replaced the segment. Cheap to call
+  // every so often, returns whether attached.
+  bool attach();
+  void detach() { mapping_ = Mapping(); }
+  bool is_attached() const { return mapping_.is_mapped(); }
+
+  // Copy the latest frame into out if it is newer than out's. Returns false when there is
+  // nothing new (or not attached).
+  bool read(Snapshot& out) const;
+
+ private:
+  std::string name_;
+  Mapping mapping_;
+  uint64_t session_ = 0;
+};
+
+}  // namespace live
@@ -0,0 +1,71 @@
+// Headless run that publishes every step for viewers:  ./orbits_headless [steps] [--realtime]
+// Runs until stopped if steps is 0. Attach with ./orbits_viewer at any time.
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../common.h"
+#include "../Simulation.h"
+#include "../Scenes.h"
+#include "../Diagnostics.h"
+#include "StateChannel.h"
+
+namespace {
+
+constexpr float DT = 1.0 / 60.0;
+constexpr size_t REPORT_INTERVAL = 600;   // Steps between progress lines
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) { stop_requested = 1; }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t steps = 0;
+  bool realtime = false;   // Pace to DT per step, otherwise run flat out
+  for (int a = 1; a < argc; ++a) {
+    if (std::strcmp(argv[a], "--realtime") == 0) {
+      realtime = true;
+    } else {
+      steps = std::stoul(argv[a]);
+    }
+  }
+  // Ctrl-C still unlinks the segment
+  std::signal(SIGINT, request_stop);
+  std::signal(SIGTERM, request_stop);
+
+  Simulation sim;
+  scenes::start_state(sim);
+  std::cout << "BODY NUM: " << sim.get_bodies().size() << std::endl;
+
+  live::Publisher publisher(STATE_CHANNEL_NAME, STATE_CHANNEL_CAPACITY);
+  DiagnosticsLog diagnostics(DIAGNOSTICS_INTERVAL, "diagnostics.csv");
+
+  const auto start = std::chrono::steady_clock::now();
+  auto next_frame = start;
+  for (size_t s = 0; (steps == 0 || s < steps) && !stop_requested; ++s) {
+    const bool sample = diagnostics.wants_sample(sim.get_step_count());
+    if (sample) sim.measure_next_step();
+    sim.step(DT);
+    if (sample) diagnostics.record(sim.get_diagnostics());
+
+    publisher.publish(sim.get_bodies(), sim.get_step_count(), sim.get_time());
+
+    if (sim.get_step_count() % REPORT_INTERVAL == 0) {
+      std::cout << "step " << sim.get_step_count() << ": " << diagnostics.summary() << std::endl;
+    }
+    if (realtime) {
+      next_frame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(DT));
+      std::this_thread::sleep_until(next_frame);
+    }
+  }
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << sim.get_step_count() << " steps in " << seconds << "s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,126 @@
+// Window onto a headless run started with ./orbits_headless. Can be opened and closed at any
+// time without affecting the simulation, and picks up a new run when one starts.
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+#include <Eigen/Dense>
+
+#include "../common.h"
+#include "../Body.h"
+#include "../BodyBuilder.h"
+#include "../Renderer.h"
+#include "StateChannel.h"
+
+using Eigen::Vector2f;
+
+namespace {
+
+void move_camera(auto& window, auto& main_camera, const float dx, const float dy, const float dt) {
+  // Speed is in screen pixels, so scale by zoom
+  const float zoom = main_camera.getSize().x / SCREEN_WIDTH;
+  main_camera.move({dx * dt * zoom, dy * dt * zoom});
+  window.setView(main_camera);
+}
+
+// Renderer draws Bodies, so rebuild them from the shared positions, radii and colours
+void to_bodies(const live::Snapshot& snapshot, std::vector<Body>& bodies) {
+  bodies.clear();
+  bodies.reserve(snapshot.radii.size());
+  for (size_t i = 0; i < snapshot.radii.size(); ++i) {
+    const uint32_t c = snapshot.colors[i];
+    bodies.push_back(BodyBuilder(Vector2f(snapshot.positions[2*i], snapshot.positions[2*i + 1]),
+                                 Vector2f::Zero(),
+                                 snapshot.radii[i])
+                       .set_color(sf::Color(c >> 24, (c >> 16) & 0xff, (c >> 8) & 0xff, c & 0xff))
+                       .build());
+  }
+}
+
+}  // namespace
+
+int main() {
+  live::Reader reader(STATE_CHANNEL_NAME);
+  live::Snapshot snapshot;
+  std::vector<Body> bodies;
+
+  sf::Font font;
+  const bool success = font.openFromFile("../UbuntuMono-B.ttf");
+  if (!success) { throw std::runtime_error("Failed to load font."); }
+
+  sf::Text status_text(font, "", 12);
+  status_text.setPosition(sf::Vector2f(10.0, 10.0));
+  status_text.setFillColor(sf::Color::Green);
+
+  sf::RenderWindow window(sf::VideoMode({static_cast<int>(SCREEN_WIDTH),
+                                         static_cast<int>(SCREEN_HEIGHT)}),
+                          "Fields viewer");
+  sf::View main_camera(sf::FloatRect({0.f, 0.f}, {SCREEN_WIDTH, SCREEN_HEIGHT}));
+  window.setView(main_camera);
+
+  Renderer renderer(window.getSize());
+
+  sf::Clock delta_clock;
+  sf::Clock attach_clock;
+  sf::Clock frame_age_clock;   // Time since the last new frame
+  float dt = 1.0/60.0;
+  reader.attach();
+
+  while (window.isOpen()) {
+    while (const std::optional event = window.pollEvent()) {
+      if (event->is<sf::Event::Closed>())
+          window.close();
+
+      // Zoom
+      if (const auto* wheel = event->getIf<sf::Event::MouseWheelScrolled>()) {
+        main_camera.zoom(1.0f - CAMERA_ZOOM_STEP * wheel->delta);
+        window.setView(main_camera);
+      }
+    }
+
+    // Camera
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Up))    move_camera(window, main_camera,           0.0, -CAMERA_SPEED, dt);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Down))  move_camera(window, main_camera,           0.0,  CAMERA_SPEED, dt);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Left))  move_camera(window, main_camera, -CAMERA_SPEED,           0.0, dt);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Right)) move_camera(window, main_camera,  CAMERA_SPEED,           0.0, dt);
+
+    // -- Fetch the latest frame --
+    if (attach_clock.getElapsedTime().asSeconds() > VIEWER_REATTACH_SECONDS) {
+      // Picks up a publisher that started (or restarted) since
+      reader.attach();
+      attach_clock.restart();
+    }
+    if (reader.read(snapshot)) {
+      to_bodies(snapshot, bodies);
+      frame_age_clock.restart();
+    }
+
+    std::string status;
+    if (!reader.is_attached()) {
+      status = "Waiting for orbits_headless...";
+    } else {
+      status = "step " + std::to_string(snapshot.step) + "  t " + std::to_string(snapshot.time) +
+               "  bodies " + std::to_string(bodies.size());
+      if (snapshot.truncated) status += " (truncated)";
+      if (frame_age_clock.getElapsedTime().asSeconds() > VIEWER_REATTACH_SECONDS) status += "  [stalled]";
+    }
+    status_text.setString(status);
+
+    // Draw
+    window.clear(sf::Color::Black);
+    renderer.draw(window, bodies, false);
+
+    window.setView(window.getDefaultView());
+    window.draw(status_text);
+    window.setView(main_camera);
+
+    window.display();
+
+    dt = delta_clock.restart().asSeconds();
+  }
+
+  return 0;
+}
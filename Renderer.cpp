@@ -0,0 +1,149 @@
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "common.h"
+
+namespace {
+
+inline int32_t grid_cell(const float x) {
+  return static_cast<int32_t>(std::floor(x / RENDER_GRID_CELL));
+}
+
+inline int64_t grid_key(const int32_t cx, const int32_t cy) {
+  return (static_cast<int64_t>(cx) << 32) | static_cast<uint32_t>(cy);
+}
+
+}  // namespace
+
+Renderer::Renderer(const sf::Vector2u target_size) :
+  body_shape_(1.0f, 200),
+  density_size_(std::max(1u, target_size.x / DENSITY_TEXEL_PIXELS),
+                std::max(1u, target_size.y / DENSITY_TEXEL_PIXELS)),
+  density_(density_size_.x * density_size_.y * 3),
+  density_pixels_(density_size_.x * density_size_.y * 4)
+{
+  body_shape_.setFillColor(sf::Color::White);
+  if (!density_texture_.resize(density_size_)) {
+    throw std::runtime_error("Failed to create density texture.");
+  }
+  density_texture_.setSmooth(true);
+}
+
+void Renderer::draw(sf::RenderTarget& target, const std::vector<Body>& bodies, const bool render_acc) {
+  rebuild_grid(bodies);
+
+  const sf::View& view = target.getView();
+  const sf::Vector2f view_size = view.getSize();
+  const sf::Vector2f view_top_left = view.getCenter() - view_size / 2.f;
+  const float pixels_per_unit = static_cast<float>(target.getSize().x) / view_size.x;
+  const sf::Vector2f texels_per_unit(static_cast<float>(density_size_.x) / view_size.x,
+                                     static_cast<float>(density_size_.y) / view_size.y);
+  const float pixel_area = static_cast<float>(DENSITY_TEXEL_PIXELS * DENSITY_TEXEL_PIXELS);
+
+  std::fill(density_.begin(), density_.end(), 0.0f);
+  circle_count_ = 0;
+  density_count_ = 0;
+
+  // Bodies are binned by centre, so widen the view by the biggest radius
+  const int32_t x0 = grid_cell(view_top_left.x - max_radius_);
+  const int32_t y0 = grid_cell(view_top_left.y - max_radius_);
+  const int32_t x1 = grid_cell(view_top_left.x + view_size.x + max_radius_);
+  const int32_t y1 = grid_cell(view_top_left.y + view_size.y + max_radius_);
+
+  const auto draw_cell = [&](const std::vector<size_t>& members) {
+    for (const size_t i : members) {
+      const Body& body = bodies[i];
+      const Vector2f& x = body.get_position();
+      const float r = body.get_radius();
+      // Exact check against the view
+      if (x.x() + r < view_top_left.x || x.x() - r > view_top_left.x + view_size.x ||
+          x.y() + r < view_top_left.y || x.y() - r > view_top_left.y + view_size.y) continue;
+
+      const float pixel_radius = r * pixels_per_unit;
+      if (pixel_radius < LOD_MIN_PIXEL_RADIUS) {
+        splat(body, view_top_left, texels_per_unit, M_PI * pixel_radius * pixel_radius / pixel_area);
+        ++density_count_;
+        continue;
+      }
+
+      // Fewer points for circles that are small on screen
+      body_shape_.setPointCount(std::clamp(static_cast<size_t>(pixel_radius * 2.0f), size_t(8), size_t(200)));
+      body.draw(target, body_shape_);
+      if (render_acc) body.render_acc(target);
+      ++circle_count_;
+    }
+  };
+
+  // Zoomed far out the view can span more cells than are occupied, so walk whichever is smaller
+  const int64_t view_cells = static_cast<int64_t>(x1 - x0 + 1) * static_cast<int64_t>(y1 - y0 + 1);
+  if (view_cells <= static_cast<int64_t>(grid_.size())) {
+    for (int32_t cx = x0; cx <= x1; ++cx) {
+      for (int32_t cy = y0; cy <= y1; ++cy) {
+        const auto cell = grid_.find(grid_key(cx, cy));
+        if (cell != grid_.end()) draw_cell(cell->second);
+      }
+    }
+  } else {
+    for (const auto& [key, members] : grid_) {
+      const int32_t cx = static_cast<int32_t>(key >> 32);
+      const int32_t cy = static_cast<int32_t>(static_cast<uint32_t>(key));
+      if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) draw_cell(members);
+    }
+  }
+
+  if (density_count_ > 0) draw_density(target, view_top_left, view_size);
+}
+
+void Renderer::rebuild_grid(const std::vector<Body>& bodies) {
+  // Keep cells (and their allocations) between frames, unless bodies have spread far away
+  if (grid_.size() > 4 * bodies.size() + 64) grid_.clear();
+  for (auto& [key, members] : grid_) members.clear();
+  max_radius_ = 0.0;
+
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    const Vector2f& x = bodies[i].get_position();
+    grid_[grid_key(grid_cell(x.x()), grid_cell(x.y()))].push_back(i);
+    max_radius_ = std::max(max_radius_, bodies[i].get_radius());
+  }
+}
+
+void Renderer::splat(const Body& body, const sf::Vector2f& view_top_left, const sf::Vector2f& texels_per_unit,
+                     const float coverage) {
+  const Vector2f& x = body.get_position();
+  const int tx = static_cast<int>((x.x() - view_top_left.x) * texels_per_unit.x);
+  const int ty = static_cast<int>((x.y() - view_top_left.y) * texels_per_unit.y);
+  if (tx < 0 || ty < 0 || tx >= static_cast<int>(density_size_.x) || ty >= static_cast<int>(density_size_.y)) return;
+
+  // Weighted by how much of the texel the body would have covered
+  const sf::Color color = body.get_color();
+  float* texel = &density_[(ty * density_size_.x + tx) * 3];
+  texel[0] += coverage * color.r / 255.0f;
+  texel[1] += coverage * color.g / 255.0f;
+  texel[2] += coverage * color.b / 255.0f;
+}
+
+void Renderer::draw_density(sf::RenderTarget& target, const sf::Vector2f& view_top_left,
+                            const sf::Vector2f& view_size) {
+  // Saturating tone map, so dense clumps read as bright rather than clipping straight away
+  const size_t texels = density_size_.x * density_size_.y;
+  for (size_t t = 0; t < texels; ++t) {
+    uint8_t max_channel = 0;
+    for (size_t c = 0; c < 3; ++c) {
+      const uint8_t value = static_cast<uint8_t>(255.0f * (1.0f - std::exp(-DENSITY_GAIN * density_[t*3 + c])));
+      density_pixels_[t*4 + c] = value;
+      max_channel = std::max(max_channel, value);
+    }
+    density_pixels_[t*4 + 3] = max_channel;
+  }
+  density_texture_.update(density_pixels_.data());
+
+  sf::Sprite sprite(density_texture_);
+  sprite.setPosition(view_top_left);
+  sprite.setScale({view_size.x / static_cast<float>(density_size_.x),
+                   view_size.y / static_cast<float>(density_size_.y)});
+  target.draw(sprite);
+}
+
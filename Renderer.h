@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Body.h"
+
+// Draws bodies with level of detail. Only bodies in (or overlapping) the target's current
+// view are visited, using a grid of body indices. Bodies smaller than a pixel are not drawn
+// as circles, but accumulated into a density map texture covering the view.
+class Renderer {
+ public:
+  Renderer(const sf::Vector2u target_size);
+
+  void draw(sf::RenderTarget& target, const std::vector<Body>& bodies, const bool render_acc);
+
+  // Stats from the last draw
+  size_t get_circle_count() const { return circle_count_; }
+  size_t get_density_count() const { return density_count_; }
+
+ private:
+  void rebuild_grid(const std::vector<Body>& bodies);
+  // coverage is the fraction of a texel the body would cover
+  void splat(const Body& body, const sf::Vector2f& view_top_left, const sf::Vector2f& texels_per_unit,
+             const float coverage);
+  void draw_density(sf::RenderTarget& target, const sf::Vector2f& view_top_left, const sf::Vector2f& view_size);
+
+  sf::CircleShape body_shape_;
+
+  // -- Culling --
+  std::unordered_map<int64_t, std::vector<size_t>> grid_;   // Cell -> body indices
+  float max_radius_ = 0.0;
+
+  // -- Density map --
+  sf::Vector2u density_size_;
+  std::vector<float> density_;          // rgb per texel
+  std::vector<uint8_t> density_pixels_; // rgba per texel
+  sf::Texture density_texture_;
+
+  size_t circle_count_ = 0;
+  size_t density_count_ = 0;
+};
+
@@ -0,0 +1,95 @@
+#include "Scenes.h"
+
+#include <cmath>
+#include <random>
+
+#include "common.h"
+#include "tools.h"
+
+namespace scenes {
+
+void spawn_planet_with_moons(
+  Simulation& sim,
+  const Vector2f position,
+  const Vector2f frame_velocity,
+  const float main_planet_radius,
+  const size_t moon_num,
+  const float moon_orbit_radius_range[2],    // Starting from surface of planet
+  const float moon_body_radius_range[2],
+  const bool orbit_direction_clockwise  // anticlockwise = false, clockwise = true
+) {
+  BodyBuilder builder(position, frame_velocity, main_planet_radius);
+  builder.with_gravity();
+  sim.add_body(builder.build());
+
+  const float main_planet_mass = sim.get_bodies().back().get_mass();
+
+  // let mut rng = rand::thread_rng();
+
+  //   let orbit_rad_range = Uniform::from(moon_orbit_radius_range.0..moon_orbit_radius_range.1);
+  //   let angle_range = Uniform::from(0.0..TWO_PI);
+  //   let size_rad_range = Uniform::from(moon_body_radius_range.0..moon_body_radius_range.1);
+
+  std::random_device rd;
+  std::mt19937 e2(rd());
+  std::uniform_real_distribution<> dist(0.0, 1.0);
+
+  for (size_t n = 0; n < moon_num; ++n) {
+    const float orbit_radius = main_planet_radius + moon_orbit_radius_range[0] + dist(e2) * (moon_orbit_radius_range[1] - moon_orbit_radius_range[0]);
+    const float orbit_speed = tools::circular_orbit_speed(main_planet_mass, orbit_radius);
+    const float start_angle = dist(e2) * 2.0 * M_PI;      // Angle from main planet to moon
+    const Vector2f start_pos = tools::get_components(orbit_radius, start_angle);   // Position on circle orbit where planet will start
+
+    const Vector2f start_velocity = tools::get_components(
+      orbit_speed,
+      orbit_direction_clockwise ? start_angle + M_PI/2.0 : start_angle - M_PI/2.0
+    );
+
+    const float moon_radius = moon_body_radius_range[0] + dist(e2) * (moon_body_radius_range[1] - moon_body_radius_range[0]);
+
+    BodyBuilder builder(position + start_pos,
+                        start_velocity + frame_velocity,
+                        moon_radius);
+    builder.with_gravity();
+    sim.add_body(builder.build());
+  }
+}
+
+void start_state(Simulation& sim) {
+  sim.clear();
+
+  /*
+  spawn_square_of_bodies(sim, Vector2f(100.0, 100.0), Vector2f::Zero(), 15, 15, SPAWN_RADIUS,
+                         [](size_t i, size_t j, BodyBuilder& builder) {
+                           builder
+                                  //.with_charge(static_cast<bool>((i + j) & 1));
+                                  .with_gravity();
+                         });
+  */
+  /*
+  spawn_square_of_bodies(sim, Vector2f(150.0, 150.0), Vector2f::Zero(), 25, 25, 10.0,
+                         [](size_t i, size_t j, BodyBuilder& builder) {
+                           builder
+                                  //.with_charge(static_cast<bool>((i + j) & 1));
+                                  .with_gravity();
+                         });
+  */
+  /*
+  spawn_square_of_bodies(sim, Vector2f(150.0, 150.0), Vector2f::Zero(), 40, 40, 6.0,
+                         [](size_t i, size_t j, BodyBuilder& builder) {
+                           builder
+                                  .with_screened_charge(static_cast<float>((i + j) & 1) - 0.5f);
+                         });
+  */
+
+  // --- planets ---
+  constexpr float orbit_range[2] = {150.0, 300.0};
+  constexpr float   rad_range[2] = {0.5, 3.0};
+  constexpr size_t           num = 500;
+  spawn_planet_with_moons(sim, Vector2f(SCREEN_WIDTH/2, SCREEN_HEIGHT/2),
+                          Vector2f::Zero(), 50.0, num, orbit_range,
+                          rad_range, true);
+}
+
+}  // namespace scenes
+
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include "BodyBuilder.h"
+#include "Simulation.h"
+
+using Eigen::Vector2f;
+
+// Starting configurations of bodies
+namespace scenes {
+
+template<typename ExtraBuildStepFunctor>
+void spawn_square_of_bodies(
+  Simulation& sim,
+  Vector2f top_left,
+  Vector2f v,
+  const size_t w,
+  const size_t h,
+  const float rad,
+  ExtraBuildStepFunctor Bfunc
+) {
+  for (size_t i = 0; i < w; ++i) {
+    for (size_t j = 0; j < h; ++j) {
+      BodyBuilder builder = BodyBuilder(Vector2f(top_left.x() + static_cast<float>(i) * rad * 2.0,
+                                                 top_left.y() + static_cast<float>(j) * rad * 2.0),
+                                        v,
+                                        rad + 1.0);
+
+      Bfunc(i, j, builder);   // Apply custom step
+      sim.add_body(builder.build());
+    }
+  }
+}
+
+void spawn_planet_with_moons(
+  Simulation& sim,
+  const Vector2f position,
+  const Vector2f frame_velocity,
+  const float main_planet_radius,
+  const size_t moon_num,
+  const float moon_orbit_radius_range[2],    // Starting from surface of planet
+  const float moon_body_radius_range[2],
+  const bool orbit_direction_clockwise  // anticlockwise = false, clockwise = true
+);
+
+// Reset bodies to start state
+void start_state(Simulation& sim);
+
+}  // namespace scenes
+
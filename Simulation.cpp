@@ -0,0 +1,406 @@
+#include "Simulation.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <Eigen/Dense>
+
+#include "common.h"
+
+using Eigen::Vector2f;
+using Eigen::Vector2d;
+
+namespace {
+
+// Contact passes visit pairs where at least one body is awake: (awake i, any j > i) then
+// (awake i, sleeping j < i). With everything awake this is every pair, in the usual order.
+// awake and asleep are taken once at the start of resolve_contacts, so bodies woken by one
+// pass don't drop out of that pass or the ones after it.
+template<typename PairFunc>
+void for_each_awake_pair(std::vector<Body>& bodies, const std::vector<size_t>& awake,
+                         const std::vector<bool>& asleep, const bool reverseOrder, PairFunc func) {
+  if (reverseOrder) {
+    for (auto it = awake.rbegin(); it != awake.rend(); ++it) {
+      for (size_t j = bodies.size()-1; j > *it; --j) func(*it, j);
+    }
+    for (auto it = awake.rbegin(); it != awake.rend(); ++it) {
+      for (size_t j = 0; j < *it; ++j) {
+        if (asleep[j]) func(*it, j);
+      }
+    }
+  } else {
+    for (const size_t i : awake) {
+      for (size_t j = i+1; j < bodies.size(); ++j) func(i, j);
+    }
+    for (const size_t i : awake) {
+      for (size_t j = 0; j < i; ++j) {
+        if (asleep[j]) func(i, j);
+      }
+    }
+  }
+}
+
+template<typename WakeFunc>
+void eliminate_crossover(std::vector<Body>& bodies, const std::vector<size_t>& awake,
+                         const std::vector<bool>& asleep, const Boundary& boundary,
+                         const bool reverseOrder, WakeFunc wake) {
+  Vector2f dist_vec;
+  float dist;
+
+  for_each_awake_pair(bodies, awake, asleep, reverseOrder, [&](const size_t i, const size_t j) {
+    Body& a = bodies[i];
+    Body& b = bodies[j];
+    dist_vec = boundary.displacement(a.get_position(), b.get_position());
+    dist = dist_vec.norm();
+    if (dist < a.get_radius() + b.get_radius()) {
+      // Touching a sleeping body wakes it (and its island)
+      if (b.is_asleep()) wake(j);
+      a.correct_overlap_with(b, dist_vec, dist);
+    }
+  });
+}
+
+// Also records touching pairs (within SLEEP_CONTACT_MARGIN) for building islands
+template<typename WakeFunc>
+void process_elastic_coll(std::vector<Body>& bodies, const std::vector<size_t>& awake,
+                          const std::vector<bool>& asleep, const Boundary& boundary, const float dt,
+                          std::vector<std::pair<size_t, size_t>>& contacts, WakeFunc wake) {
+  Vector2f dist_vec;
+  float dist;
+
+  for_each_awake_pair(bodies, awake, asleep, false, [&](const size_t i, const size_t j) {
+    Body& a = bodies[i];
+    Body& b = bodies[j];
+    dist_vec = boundary.displacement(a.get_position(), b.get_position());
+    dist = dist_vec.norm();
+    const float touching = a.get_radius() + b.get_radius();
+    if (dist < touching + SLEEP_CONTACT_MARGIN && b.is_asleep()) wake(j);
+    // Process collisions
+    if (dist < touching) {
+      a.elastic_collide_with(b, dist_vec, dist, dt);
+    }
+    if (dist < touching + SLEEP_CONTACT_MARGIN) {
+      contacts.emplace_back(i, j);
+    }
+  });
+}
+
+}  // namespace
+
+Simulation::Simulation() :
+  boundary_(eOpenBoundary, SCREEN_WIDTH, SCREEN_HEIGHT),
+  near_gravity_field_(gravity_field_, RESPA_SWITCH_START, RESPA_SWITCH_END),
+  near_electric_field_(electric_field_, RESPA_SWITCH_START, RESPA_SWITCH_END)
+{}
+
+void Simulation::add_body(const Body& body) {
+  bodies_.emplace_back(body);
+  index_.add(bodies_.back(), bodies_.size() - 1);
+  island_of_.push_back(NO_ISLAND);
+}
+
+void Simulation::clear() {
+  bodies_.clear();
+  index_.clear();
+  wake_all();
+}
+
+void Simulation::bodies_changed() {
+  index_.rebuild(bodies_);
+  wake_all();
+  screened_field_.invalidate();
+  periodic_electric_field_.invalidate();
+  near_gravity_field_.invalidate();
+  near_electric_field_.invalidate();
+}
+
+void Simulation::set_boundary_mode(const eBoundaryMode mode) {
+  boundary_.set_mode(mode);
+  // Bring everything inside the box straight away
+  for (auto& body : bodies_) {
+    boundary_.apply(body);
+  }
+  wake_all();
+  screened_field_.invalidate();
+  periodic_electric_field_.invalidate();
+  near_gravity_field_.invalidate();
+  near_electric_field_.invalidate();
+}
+
+void Simulation::step(const float dt) {
+  reset_forces();
+  if (measure_next_) {
+    diagnostics_ = Diagnostics();
+    diagnostics_.step = step_count_;
+    diagnostics_.time = time_;
+    for (const auto& body : bodies_) {
+      const Vector2d x = body.get_position().cast<double>();
+      const Vector2d p = body.get_mass() * body.get_velocity().cast<double>();
+      diagnostics_.kinetic += 0.5 * p.dot(body.get_velocity().cast<double>());
+      diagnostics_.momentum += p;
+      diagnostics_.angular_momentum += x.x() * p.y() - x.y() * p.x();
+    }
+    apply_fields(dt, &diagnostics_.potential);
+    measure_next_ = false;
+  } else {
+    apply_fields(dt);
+  }
+  wake_disturbed();
+  if (respa_substeps_ > 1) {
+    respa_step(dt);
+  } else {
+    integrate(dt);
+    resolve_contacts(dt);
+  }
+  update_sleep(dt);
+
+  ++step_count_;
+  time_ += dt;
+}
+
+void Simulation::reset_forces() {
+  for (auto& body : bodies_) {
+    body.reset_forces();
+  }
+}
+
+void Simulation::apply_fields(const float dt, double* potential) {
+  // Gravity and charge pairs flag close encounter candidates as they go
+  close_pairs_.pairs.clear();
+  close_pairs_.rate = EncounterIntegrator::candidate_rate(dt);
+  fields::ClosePairs* close = encounters_enabled_ ? &close_pairs_ : nullptr;
+
+  // Each field only visits the bodies that have its attribute
+  gravity_field_.apply_forces(bodies_, index_.members<fields::GravityAttribute>(), boundary_, potential, close);
+  if (boundary_.is_periodic()) {
+    // Summed over every periodic image on a mesh
+    periodic_electric_field_.apply_forces(bodies_, index_.members<fields::ChargeAttribute>(), boundary_, potential);
+  } else {
+    electric_field_.apply_forces(bodies_, index_.members<fields::ChargeAttribute>(), boundary_, potential, close);
+  }
+  // Short range fields only visit neighbours
+  screened_field_.apply_forces(bodies_, index_.members<fields::ScreenedChargeAttribute>(), boundary_, potential);
+}
+
+void Simulation::apply_near_fields(const float dt) {
+  // Adds to the candidates from the full pass, which cover the whole step
+  close_pairs_.rate = EncounterIntegrator::candidate_rate(dt);
+  fields::ClosePairs* close = encounters_enabled_ ? &close_pairs_ : nullptr;
+
+  near_gravity_field_.apply_forces(bodies_, index_.members<fields::GravityAttribute>(), boundary_, nullptr, close);
+  near_electric_field_.apply_forces(bodies_, index_.members<fields::ChargeAttribute>(), boundary_, nullptr, close);
+  screened_field_.apply_forces(bodies_, index_.members<fields::ScreenedChargeAttribute>(), boundary_);
+}
+
+void Simulation::respa_step(const float dt) {
+  // Slow part: the full force pass minus the near part, given as one impulse for the whole
+  // step. In a periodic box the near charge is the nearest image only, the mesh keeps the rest.
+  slow_forces_.resize(bodies_.size());
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    slow_forces_[i] = bodies_[i].get_force();
+  }
+  const float h = dt / static_cast<float>(respa_substeps_);
+  reset_forces();
+  apply_near_fields(h);
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    Body& body = bodies_[i];
+    slow_forces_[i] -= body.get_force();
+    if (!body.is_asleep()) body.kick(slow_forces_[i], dt);
+  }
+
+  // Fast part: near fields and contacts every inner step
+  for (size_t s = 0; s < respa_substeps_; ++s) {
+    if (s > 0) {
+      reset_forces();
+      apply_near_fields(h);
+    }
+    integrate(h);
+    resolve_contacts(h);
+  }
+
+  // Leave the full force on the bodies, for render_acc and waking sleepers
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    bodies_[i].apply_force(slow_forces_[i]);
+  }
+}
+
+void Simulation::sample_gravity(const std::vector<Vector2f>& probes,
+                                std::vector<fields::FieldSample>& out) const {
+  gravity_field_.sample(bodies_, index_.members<fields::GravityAttribute>(), boundary_, probes, out);
+}
+
+void Simulation::sample_charge(const std::vector<Vector2f>& probes,
+                               std::vector<fields::FieldSample>& out) const {
+  if (boundary_.is_periodic()) {
+    periodic_electric_field_.sample(bodies_, index_.members<fields::ChargeAttribute>(), boundary_, probes, out);
+  } else {
+    electric_field_.sample(bodies_, index_.members<fields::ChargeAttribute>(), boundary_, probes, out);
+  }
+}
+
+void Simulation::integrate(const float dt) {
+  // Close pairs are taken out of the Euler step and sub-stepped. Periodic charge comes off the
+  // PME mesh, so it isn't pairwise and stays in the fixed part of their force.
+  const bool periodic = boundary_.is_periodic();
+  if (encounters_enabled_) {
+    encounters_.find(bodies_, index_, boundary_, dt, !periodic, close_pairs_.pairs);
+  } else {
+    encounters_ = EncounterIntegrator();
+  }
+
+  // Euler step
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    Body& body = bodies_[i];
+    if (body.is_asleep() || encounters_.contains(i)) continue;
+    body.step(dt);
+    boundary_.apply(body);
+  }
+
+  encounters_.integrate(bodies_, boundary_, dt,
+                        [this, periodic](const Body& a, const Body& b, const Vector2f& dist_vec) -> Vector2f {
+                          Vector2f force = gravity_field_.pair_force(a, b, dist_vec);
+                          if (!periodic) force += electric_field_.pair_force(a, b, dist_vec);
+                          return force;
+                        });
+}
+
+void Simulation::resolve_contacts(const float dt) {
+  // Pairs of sleeping bodies are skipped, they were at rest when they fell asleep. Islands an
+  // awake body has reached are woken first, so the passes treat them as awake throughout.
+  wake_touched();
+  awake_.clear();
+  asleep_.resize(bodies_.size());
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    asleep_[i] = bodies_[i].is_asleep();
+    if (!asleep_[i]) awake_.push_back(i);
+  }
+  const auto wake = [this](const size_t i) { wake_island(i); };
+
+  // Overlap passes
+  for (size_t o = 0; o < 2; ++o) {
+    eliminate_crossover(bodies_, awake_, asleep_, boundary_, static_cast<bool>(o % 2), wake);
+  }
+  // Process collisions
+  contacts_.clear();
+  process_elastic_coll(bodies_, awake_, asleep_, boundary_, dt, contacts_, wake);
+}
+
+// -- Sleeping --
+
+void Simulation::set_sleeping_enabled(const bool enabled) {
+  sleeping_enabled_ = enabled;
+  if (!enabled) wake_all();
+}
+
+size_t Simulation::count_asleep() const {
+  return std::count_if(bodies_.begin(), bodies_.end(),
+                       [](const Body& body) { return body.is_asleep(); });
+}
+
+void Simulation::wake_all() {
+  for (auto& body : bodies_) {
+    body.wake();
+  }
+  island_of_.assign(bodies_.size(), NO_ISLAND);
+  sleeping_islands_.clear();
+}
+
+void Simulation::wake_island(const size_t i) {
+  const auto it = i < island_of_.size() ? sleeping_islands_.find(island_of_[i]) : sleeping_islands_.end();
+  if (it == sleeping_islands_.end()) [[unlikely]] {
+    bodies_[i].wake();
+    return;
+  }
+  for (const size_t member : it->second) {
+    bodies_[member].wake();
+    island_of_[member] = NO_ISLAND;
+  }
+  sleeping_islands_.erase(it);
+}
+
+void Simulation::wake_disturbed() {
+  // A sleeper's force is balanced by its contacts, so only a change in force disturbs it,
+  // e.g a body flying past
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    const Body& body = bodies_[i];
+    if (!body.is_asleep()) continue;
+    if (body.force_change_since_sleep().norm() > WAKE_ACCEL_CHANGE * body.get_mass()) {
+      wake_island(i);
+    }
+  }
+}
+
+void Simulation::wake_touched() {
+  std::vector<size_t> awake;
+  std::vector<size_t> asleep;
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    (bodies_[i].is_asleep() ? asleep : awake).push_back(i);
+  }
+  if (asleep.empty()) return;
+
+  for (const size_t i : awake) {
+    const Body& a = bodies_[i];
+    for (const size_t j : asleep) {
+      const Body& b = bodies_[j];
+      if (!b.is_asleep()) continue;   // Woken with an earlier island
+      const float reach = a.get_radius() + b.get_radius() + SLEEP_CONTACT_MARGIN;
+      if (boundary_.displacement(a.get_position(), b.get_position()).squaredNorm() < reach * reach) {
+        wake_island(j);
+      }
+    }
+  }
+}
+
+void Simulation::update_sleep(const float dt) {
+  if (!sleeping_enabled_) return;
+
+  for (const size_t i : awake_) {
+    bodies_[i].update_stillness(SLEEP_SPEED);
+  }
+
+  // Group touching awake bodies into islands (union-find)
+  std::vector<size_t> parent(bodies_.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  const auto find = [&](size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  for (const auto& [i, j] : contacts_) {
+    parent[find(i)] = find(j);
+  }
+
+  // Includes bodies woken during this step, which keep their island awake
+  std::unordered_map<size_t, std::vector<size_t>> islands;
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    if (!bodies_[i].is_asleep()) islands[find(i)].push_back(i);
+  }
+
+  for (auto& [root, members] : islands) {
+    // Every member must have been still for a while, and the island as a whole must not be
+    // about to accelerate
+    bool still = true;
+    Vector2f net_force = Vector2f::Zero();
+    float mass = 0.0;
+    for (const size_t i : members) {
+      const Body& body = bodies_[i];
+      if (body.get_still_frames() < SLEEP_FRAMES) {
+        still = false;
+        break;
+      }
+      net_force += body.get_force();
+      mass += body.get_mass();
+    }
+    if (!still || net_force.norm() * dt >= SLEEP_SPEED * mass) continue;
+
+    const size_t id = next_island_id_++;
+    for (const size_t i : members) {
+      bodies_[i].sleep();
+      island_of_[i] = id;
+    }
+    sleeping_islands_.emplace(id, std::move(members));
+  }
+}
+
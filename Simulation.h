@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Body.h"
+#include "Boundary.h"
+#include "Diagnostics.h"
+#include "Encounters.h"
+#include "Fields/Gravity.h"
+#include "Fields/Charge.h"
+#include "Fields/ScreenedCharge.h"
+#include "Fields/EwaldCharge.h"
+#include "Fields/NearField.h"
+#include "Fields/AttributeIndex.h"
+
+// Owns the bodies and fields, and advances them in time.
+class Simulation {
+ public:
+  Simulation();
+
+  // -- Bodies --
+  void add_body(const Body& body);
+  void clear();
+  std::vector<Body>& get_bodies() { return bodies_; }
+  const std::vector<Body>& get_bodies() const { return bodies_; }
+  // Call after adding/removing/reordering bodies through get_bodies()
+  void bodies_changed();
+  // Which bodies have each attribute
+  const fields::AttributeIndex& get_index() const { return index_; }
+
+  // -- Boundary --
+  const Boundary& get_boundary() const { return boundary_; }
+  void set_boundary_mode(const eBoundaryMode mode);
+
+  // -- Diagnostics --
+  // Measure energy and momentum during the next step, at the start of step positions.
+  // Potential energy is accumulated by the force pass, so this costs O(N) extra.
+  void measure_next_step() { measure_next_ = true; }
+  const Diagnostics& get_diagnostics() const { return diagnostics_; }
+  size_t get_step_count() const { return step_count_; }
+  double get_time() const { return time_; }
+
+  // -- Field sampling --
+  // Field and potential felt by a unit mass/charge at arbitrary points, e.g for visualisation or
+  // tracer particles. Uses the index, and the PME mesh from the last step when periodic.
+  void sample_gravity(const std::vector<Vector2f>& probes, std::vector<fields::FieldSample>& out) const;
+  void sample_charge(const std::vector<Vector2f>& probes, std::vector<fields::FieldSample>& out) const;
+
+  // -- Sleeping --
+  // Islands of touching bodies that stay at rest for SLEEP_FRAMES steps stop being stepped, and
+  // contacts between sleepers are skipped. Woken by a contact or a change in force.
+  void set_sleeping_enabled(const bool enabled);
+  bool is_sleeping_enabled() const { return sleeping_enabled_; }
+  size_t count_asleep() const;
+
+  // -- Close encounters --
+  // Pairs whose gravity/charge is too fast for the step are sub-stepped on their own
+  void set_encounters_enabled(const bool enabled) { encounters_enabled_ = enabled; }
+  bool is_encounters_enabled() const { return encounters_enabled_; }
+  size_t count_encounters() const { return encounters_.count_pairs(); }
+
+  // -- Multiple time stepping --
+  // With more than 1 substep, forces between bodies closer than RESPA_SWITCH_END (and screened
+  // charge) are recomputed, and contacts resolved, every dt/substeps. The rest of the fields is
+  // applied once per step as an impulse, so the full force pass runs `substeps` times less often.
+  void set_respa_substeps(const size_t substeps) { respa_substeps_ = std::max<size_t>(substeps, 1); }
+  size_t get_respa_substeps() const { return respa_substeps_; }
+
+  // -- Physics --
+  // Full step: fields, Euler step (close pairs sub-stepped) then contacts, or RESPA steps. Forces are kept until the next step (for render_acc).
+  void step(const float dt);
+
+  //    Individual phases of a step
+  void reset_forces();
+  //    dt is the step the forces are for, close encounter candidates are flagged against it
+  void apply_fields(const float dt, double* potential = nullptr);
+  void integrate(const float dt);
+  void resolve_contacts(const float dt);
+  //    Near part of the fields only, see set_respa_substeps
+  void apply_near_fields(const float dt);
+
+ private:
+  void wake_all();
+  void wake_island(const size_t i);
+  // Wakes sleepers whose force has changed a lot
+  void wake_disturbed();
+  // Wakes islands that an awake body is touching (within SLEEP_CONTACT_MARGIN)
+  void wake_touched();
+  // Puts islands that have come to rest to sleep
+  void update_sleep(const float dt);
+  // Far field impulse then inner steps, forces must hold the full force pass
+  void respa_step(const float dt);
+
+  std::vector<Body> bodies_;
+  fields::AttributeIndex index_;
+  Boundary boundary_;
+
+  size_t step_count_ = 0;
+  double time_ = 0.0;
+  bool measure_next_ = false;
+  Diagnostics diagnostics_;
+
+  static constexpr size_t NO_ISLAND = std::numeric_limits<size_t>::max();
+  bool sleeping_enabled_ = true;
+  std::vector<size_t> awake_;                          // Awake at the start of resolve_contacts
+  std::vector<bool> asleep_;                           // And the rest, per body
+  std::vector<std::pair<size_t, size_t>> contacts_;    // Touching pairs from the last step
+  std::vector<size_t> island_of_;                      // Sleeping island of each body
+  std::unordered_map<size_t, std::vector<size_t>> sleeping_islands_;
+  size_t next_island_id_ = 0;
+
+  bool encounters_enabled_ = true;
+  EncounterIntegrator encounters_;
+  fields::ClosePairs close_pairs_;   // Candidates from the force passes since the last apply_fields
+
+  fields::Gravity gravity_field_;
+  fields::Charge electric_field_;
+  fields::ScreenedCharge screened_field_;
+  fields::EwaldCharge periodic_electric_field_;   // Replaces electric_field_ in a periodic box
+
+  size_t respa_substeps_ = RESPA_SUBSTEPS;
+  fields::NearField<fields::GravityAttribute> near_gravity_field_;
+  fields::NearField<fields::ChargeAttribute> near_electric_field_;
+  std::vector<Vector2f> slow_forces_;
+};
+
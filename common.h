@@ -1,6 +1,6 @@
 #pragma once
 
-//#define WALL_BOUNCE
+#include <cstddef>
 
 constexpr float SCREEN_WIDTH = 1200.0;
 constexpr float SCREEN_HEIGHT = 1000.0;
@@ -8,7 +8,64 @@ constexpr float SCREEN_HEIGHT = 1000.0;
 constexpr float G = 0.001;
 constexpr float COULOMB = 7e12;
 
+// Screened (Yukawa) charge - short range, so only neighbours within the cutoff interact.
+constexpr float SCREENED_COULOMB = 7e12;
+constexpr float DEBYE_LENGTH = 20.0;
+constexpr float SCREENED_CUTOFF = 4.0 * DEBYE_LENGTH;
+constexpr float VERLET_SKIN = 10.0;  // Extra radius kept in neighbour lists so they can be reused
+
+// Charge in a periodic box (particle-mesh Ewald)
+constexpr float EWALD_CUTOFF = 100.0;               // Real space part is dropped past this
+constexpr float EWALD_ALPHA = 2.75 / EWALD_CUTOFF;  // erfc(alpha * cutoff) ~ 1e-4
+constexpr size_t PME_MESH_SIZE = 128;               // Mesh points along each side, power of 2
+
+// Plummer softening lengths, 0 for none. Forces fall off as d / (d^2 + eps^2)^(3/2).
+constexpr float GRAVITY_SOFTENING = 0.0;
+constexpr float CHARGE_SOFTENING = 0.0;
+
+// Close encounters - pairs too fast for the global step are sub-stepped on their own
+constexpr float ENCOUNTER_ETA = 0.02;            // Close when dt > this * dynamical time of the pair
+constexpr float ENCOUNTER_SUBSTEP_ETA = 0.02;    // Sub-step, as a fraction of the shortest dynamical time
+constexpr size_t ENCOUNTER_MAX_SUBSTEPS = 1000;  // Per cluster per step, the last one takes what is left
+constexpr size_t ENCOUNTER_MAX_CLUSTER = 8;      // Bigger clusters are left to the Euler step
+
+// Multiple time stepping (RESPA) - forces within the switch are recomputed every inner step,
+// the rest once per outer step
+constexpr size_t RESPA_SUBSTEPS = 1;             // Inner steps per step, 1 for off
+constexpr float RESPA_SWITCH_START = 30.0;       // Fully near inside this
+constexpr float RESPA_SWITCH_END = 50.0;         // Fully far outside this
+
 constexpr float PLANET_DENSITY = 1000.0;
 constexpr float COLLISION_DAMPING = 0.925;
 
+constexpr float SPAWN_RADIUS = 7.0;
+
+// Sleeping - resting islands of bodies stop being stepped until disturbed
+constexpr float SLEEP_SPEED = 3.0;             // Bodies slower than this count as still
+constexpr unsigned SLEEP_FRAMES = 60;          // For this many steps in a row
+constexpr float SLEEP_CONTACT_MARGIN = 1.0;    // Gap that still counts as touching, for islands
+constexpr float WAKE_ACCEL_CHANGE = 30.0;      // Wake if a sleeper's acceleration changes by more
+
+constexpr size_t DIAGNOSTICS_INTERVAL = 30;   // Steps between energy/momentum samples
+
+// Rendering level of detail
+constexpr float RENDER_GRID_CELL = 64.0;         // World units per culling grid cell
+constexpr float LOD_MIN_PIXEL_RADIUS = 1.0;      // Smaller bodies go into the density map
+constexpr unsigned DENSITY_TEXEL_PIXELS = 2;     // Screen pixels per density map texel
+constexpr float DENSITY_GAIN = 1.5;
+constexpr unsigned OVERLAY_SPACING = 24;         // Screen pixels between field overlay probes
+constexpr float OVERLAY_REFRESH_PIXELS = 4.0;    // Resample once a body moves this far on screen
+constexpr float CAMERA_SPEED = 600.0;            // Screen pixels per second
+constexpr float CAMERA_ZOOM_STEP = 0.1;
+
 constexpr float FORCE_DEBUG_MUL = 8e-2; // 8e-9;
+
+// Live viewing of a headless run through shared memory
+constexpr const char* STATE_CHANNEL_NAME = "/orbits_state";
+constexpr unsigned STATE_CHANNEL_CAPACITY = 1 << 16;   // Bodies published per frame
+constexpr float VIEWER_REATTACH_SECONDS = 1.0;         // How often a viewer looks for a new run
+
+// Distributed (MPI) mode
+constexpr float SUMMARY_CELL_SIZE = 64.0;     // Bodies further than NEAR_FIELD_DIST are summarised per cell
+constexpr float NEAR_FIELD_DIST = 3.0 * SUMMARY_CELL_SIZE;  // Must cover collisions & SCREENED_CUTOFF
+constexpr size_t REBALANCE_INTERVAL = 50;     // Steps between moving domain boundaries
@@ -10,189 +10,34 @@
 #include "tools.h"
 #include "Body.h"
 #include "BodyBuilder.h"
-
-#include "Fields/Field.h"
-#include "Fields/Gravity.h"
-#include "Fields/Charge.h"
+#include "Simulation.h"
+#include "Scenes.h"
+#include "Diagnostics.h"
+#include "Renderer.h"
+#include "FieldOverlay.h"
 
 using Eigen::Vector2f;
-constexpr float SPAWN_RADIUS = 7.0;
 
 // Utils
 namespace {
 
-template<typename ExtraBuildStepFunctor>
-void spawn_square_of_bodies(
-  std::vector<Body>& bodies,
-  Vector2f top_left,
-  Vector2f v,
-  const size_t w,
-  const size_t h,
-  const float rad,
-  ExtraBuildStepFunctor Bfunc
-) {
-  for (size_t i = 0; i < w; ++i) {
-    for (size_t j = 0; j < h; ++j) {
-      BodyBuilder builder = BodyBuilder(Vector2f(top_left.x() + static_cast<float>(i) * rad * 2.0,
-                                                 top_left.y() + static_cast<float>(j) * rad * 2.0),
-                                        v,
-                                        rad + 1.0);
-
-      Bfunc(i, j, builder);   // Apply custom step
-      bodies.push_back(builder.build());
-    }
-  }
-}
-
-
-void spawn_planet_with_moons(
-  std::vector<Body>& bodies,
-  const Vector2f position,
-  const Vector2f frame_velocity,
-  const float main_planet_radius,
-  const size_t moon_num,
-  const float moon_orbit_radius_range[2],    // Starting from surface of planet
-  const float moon_body_radius_range[2],
-  const bool orbit_direction_clockwise  // anticlockwise = false, clockwise = true
-) {
-  BodyBuilder builder(position, frame_velocity, main_planet_radius);
-  builder.with_gravity();
-  bodies.emplace_back(builder.build());
-
-  const float main_planet_mass = bodies[bodies.size()-1].get_mass();
-
-  // let mut rng = rand::thread_rng();
-
-  //   let orbit_rad_range = Uniform::from(moon_orbit_radius_range.0..moon_orbit_radius_range.1);
-  //   let angle_range = Uniform::from(0.0..TWO_PI);
-  //   let size_rad_range = Uniform::from(moon_body_radius_range.0..moon_body_radius_range.1);
-
-  std::random_device rd;
-  std::mt19937 e2(rd());
-  std::uniform_real_distribution<> dist(0.0, 1.0);
-
-  for (size_t n = 0; n < moon_num; ++n) {
-    const float orbit_radius = main_planet_radius + moon_orbit_radius_range[0] + dist(e2) * (moon_orbit_radius_range[1] - moon_orbit_radius_range[0]);
-    const float orbit_speed = tools::circular_orbit_speed(main_planet_mass, orbit_radius);
-    const float start_angle = dist(e2) * 2.0 * M_PI;      // Angle from main planet to moon
-    const Vector2f start_pos = tools::get_components(orbit_radius, start_angle);   // Position on circle orbit where planet will start
-
-    const Vector2f start_velocity = tools::get_components(
-      orbit_speed,
-      orbit_direction_clockwise ? start_angle + M_PI/2.0 : start_angle - M_PI/2.0
-    );
-
-    const float moon_radius = moon_body_radius_range[0] + dist(e2) * (moon_body_radius_range[1] - moon_body_radius_range[0]);
-
-    BodyBuilder builder(position + start_pos,
-                        start_velocity + frame_velocity,
-                        moon_radius);
-    builder.with_gravity();
-    bodies.emplace_back(builder.build());
-  }
-}
-
-
-// Reset bodies to start state
-void start_state(std::vector<Body>& bodies) {
-  bodies.clear();
-
-  /*
-  spawn_square_of_bodies(bodies, Vector2f(100.0, 100.0), Vector2f::Zero(), 15, 15, SPAWN_RADIUS,
-                         [](size_t i, size_t j, BodyBuilder& builder) {
-                           builder
-                                  //.with_charge(static_cast<bool>((i + j) & 1));
-                                  .with_gravity();
-                         });
-  */
-  /*
-  spawn_square_of_bodies(bodies, Vector2f(150.0, 150.0), Vector2f::Zero(), 25, 25, 10.0,
-                         [](size_t i, size_t j, BodyBuilder& builder) {
-                           builder
-                                  //.with_charge(static_cast<bool>((i + j) & 1));
-                                  .with_gravity();
-                         });
-  */
-
-  // --- planets ---
-  constexpr float orbit_range[2] = {150.0, 300.0};
-  constexpr float   rad_range[2] = {0.5, 3.0};
-  constexpr size_t           num = 500;
-  spawn_planet_with_moons(bodies, Vector2f(SCREEN_WIDTH/2, SCREEN_HEIGHT/2),
-                          Vector2f::Zero(), 50.0, num, orbit_range,
-                          rad_range, true);
-}
-
 void move_camera(auto& window, auto& main_camera, const float dx, const float dy, const float dt) {
-  main_camera.move(dx * dt, dy * dt);
+  // Speed is in screen pixels, so scale by zoom
+  const float zoom = main_camera.getSize().x / SCREEN_WIDTH;
+  main_camera.move({dx * dt * zoom, dy * dt * zoom});
   window.setView(main_camera);
 }
 
-void eliminate_crossover(std::vector<Body>& bodies, const bool reverseOrder) {
-  if (bodies.size() < 1) [[unlikely]] return;
-
-  Vector2f dist_vec;
-  float dist;
-
-  const auto func = [&](Body& a, Body& b) {
-    dist_vec = a.displacement_to(b);
-    dist = dist_vec.norm();
-    if (dist < a.get_radius() + b.get_radius()) {
-      a.correct_overlap_with(b, dist);
-    }
-  };
-
-  if (reverseOrder) {
-    for (int i = bodies.size()-2; i > 0; --i) {
-      for (int j = bodies.size()-1; j > i; --j) {
-        func(bodies[i], bodies[j]);
-      }
-    }
-  } else {
-    for (size_t i = 0; i < bodies.size()-1; ++i) {
-      for (size_t j = i+1; j < bodies.size(); ++j) {
-        func(bodies[i], bodies[j]);
-      }
-    }
-  }
-}
-
-void process_elastic_coll(std::vector<Body>& bodies, const float dt) {
-  if (bodies.size() < 1) [[unlikely]] return;
-
-  Vector2f dist_vec;
-  float dist;
-  Body *a = &bodies[0];
-  Body *b = &bodies[1];
-
-  for (size_t i = 0; i < bodies.size()-1; ++i) {
-    a = &bodies[i];
-    for (size_t j = i+1; j < bodies.size(); ++j) {
-      b = &bodies[j];
-
-      dist_vec = a->displacement_to(*b);
-      dist = dist_vec.norm();
-      // Process collisions
-      if (dist < a->get_radius() + b->get_radius()) {
-        a->elastic_collide_with(*b, dist, dt);
-      }
-    }
-  }
-}
-
 }  // namespace
 
 int main() {
   srand((unsigned int) time(0));
 
-  std::vector<Body> bodies;
-  start_state(bodies);
+  Simulation sim;
+  scenes::start_state(sim);
   std::cout << "start state made." << std::endl;
 
   // Create assets
-  sf::CircleShape body_shape(1.0f, 200);
-  body_shape.setFillColor(sf::Color::White);
-
   sf::Font font;
   const bool success = font.openFromFile("../UbuntuMono-B.ttf");
   if (!success) { throw std::runtime_error("Failed to load font."); }
@@ -201,6 +46,13 @@ int main() {
   fps_text.setPosition(sf::Vector2f(SCREEN_WIDTH - 60.0, 10.0));
   fps_text.setFillColor(sf::Color::Green);
 
+  sf::Text diagnostics_text(font, "", 12);
+  diagnostics_text.setPosition(sf::Vector2f(10.0, 10.0));
+  diagnostics_text.setFillColor(sf::Color::Green);
+
+  // Energy & momentum, every DIAGNOSTICS_INTERVAL steps
+  DiagnosticsLog diagnostics(DIAGNOSTICS_INTERVAL, "diagnostics.csv");
+
   // Mouse
   bool dragging = false;
   auto mouse_button_held = sf::Mouse::Button::Left;
@@ -210,17 +62,18 @@ int main() {
   // Camera
   bool cam_move_up, cam_move_down, cam_move_left, cam_move_right;
 
-  std::cout << "BODY NUM: " << bodies.size() << std::endl;
-
-  // Make fields!
-  fields::Gravity gravity_field;
-  fields::Charge electric_field;
+  std::cout << "BODY NUM: " << sim.get_bodies().size() << std::endl;
 
   // create the window
   sf::RenderWindow window(sf::VideoMode({static_cast<int>(SCREEN_WIDTH),
                                          static_cast<int>(SCREEN_HEIGHT)}),
                           "Fields");
   sf::View main_camera(sf::FloatRect({0.f, 0.f}, {SCREEN_WIDTH, SCREEN_HEIGHT}));
+  window.setView(main_camera);
+
+  // Culls to the camera, sub-pixel bodies become a density map
+  Renderer renderer(window.getSize());
+  FieldOverlay overlay(window.getSize());
 
   sf::Clock delta_clock;
   float dt = 1.0/60.0;
@@ -241,6 +94,30 @@ int main() {
       // Close window: exit
       if (event->is<sf::Event::Closed>())
           window.close();
+
+      // Cycle boundary mode: open -> reflecting -> periodic
+      if (const auto* key = event->getIf<sf::Event::KeyPressed>()) {
+        if (key->scancode == sf::Keyboard::Scan::B) {
+          const auto mode = static_cast<eBoundaryMode>((sim.get_boundary().get_mode() + 1) % 3);
+          sim.set_boundary_mode(mode);
+          std::cout << "Boundary: " << boundary_mode_name(mode) << std::endl;
+        } else if (key->scancode == sf::Keyboard::Scan::V) {
+          // Cycle field overlay
+          overlay.next_mode();
+          std::cout << "Overlay: " << overlay_mode_name(overlay.get_mode()) << std::endl;
+        } else if (key->scancode == sf::Keyboard::Scan::K) {
+          // Cycle RESPA inner steps: 1 (off), 2, 4, 8
+          const size_t substeps = sim.get_respa_substeps() >= 8 ? 1 : sim.get_respa_substeps() * 2;
+          sim.set_respa_substeps(substeps);
+          std::cout << "Inner steps: " << substeps << std::endl;
+        }
+      }
+
+      // Zoom
+      if (const auto* wheel = event->getIf<sf::Event::MouseWheelScrolled>()) {
+        main_camera.zoom(1.0f - CAMERA_ZOOM_STEP * wheel->delta);
+        window.setView(main_camera);
+      }
     }
 
     // --- Mouse ---
@@ -253,9 +130,10 @@ int main() {
     } else if (dragging && !(left || right)) {   // If not pressed, and previously was then spawn a planet.
       dragging = false;
 
-      // Spawn planet with velocity
-      const auto drag = mouse_start_pos - curr_mouse_press_pos;
-      Body b = BodyBuilder(Vector2f(mouse_start_pos.x, mouse_start_pos.y),
+      // Spawn planet with velocity, in world coordinates
+      const sf::Vector2f start = window.mapPixelToCoords(mouse_start_pos);
+      const sf::Vector2f drag = start - window.mapPixelToCoords(curr_mouse_press_pos);
+      Body b = BodyBuilder(Vector2f(start.x, start.y),
                            Vector2f(drag.x, drag.y) * 5.0,
                            SPAWN_RADIUS)
                  .set_mass(tools::volume_of_sphere(SPAWN_RADIUS) * PLANET_DENSITY * 5.0)
@@ -263,14 +141,17 @@ int main() {
                  .with_gravity()
                  .build();
 
-      bodies.emplace_back(b);
+      sim.add_body(b);
+      diagnostics.reset();
     }
     // -------------
     // --- Keyboard ---
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::R)) {
-      start_state(bodies);
+      scenes::start_state(sim);
+      diagnostics.reset();
     } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::C)) {
-      bodies.clear();
+      sim.clear();
+      diagnostics.reset();
     } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::F)) {
       renderAcc = !renderAcc;
     }
@@ -278,51 +159,37 @@ int main() {
     // Mouse drag
     if (dragging) {
       curr_mouse_press_pos = sf::Mouse::getPosition(window);
-      drag_line[0] = sf::Vertex(sf::Vector2f(static_cast<float>(mouse_start_pos.x), static_cast<float>(mouse_start_pos.y)));
-      drag_line[1] = sf::Vertex(sf::Vector2f(static_cast<float>(curr_mouse_press_pos.x), static_cast<float>(curr_mouse_press_pos.y)));
+      drag_line[0] = sf::Vertex(window.mapPixelToCoords(mouse_start_pos));
+      drag_line[1] = sf::Vertex(window.mapPixelToCoords(curr_mouse_press_pos));
       drag_line[0].color = sf::Color::Green;
       drag_line[1].color = sf::Color::Green;
     }
 
     // Camera
-    // if (cam_move_up)    move_camera(window, main_camera,    0.0, -600.0, dt);
-    // if (cam_move_down)  move_camera(window, main_camera,    0.0,  600.0, dt);
-    // if (cam_move_left)  move_camera(window, main_camera, -600.0,    0.0, dt);
-    // if (cam_move_right) move_camera(window, main_camera,  600.0,    0.0, dt);
+    cam_move_up = sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Up);
+    cam_move_down = sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Down);
+    cam_move_left = sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Left);
+    cam_move_right = sf::Keyboard::isKeyPressed(sf::Keyboard::Scan::Right);
+    if (cam_move_up)    move_camera(window, main_camera,           0.0, -CAMERA_SPEED, dt);
+    if (cam_move_down)  move_camera(window, main_camera,           0.0,  CAMERA_SPEED, dt);
+    if (cam_move_left)  move_camera(window, main_camera, -CAMERA_SPEED,           0.0, dt);
+    if (cam_move_right) move_camera(window, main_camera,  CAMERA_SPEED,           0.0, dt);
 
     // -- Update physics --
-
-    // Update fields
-
-    for (size_t i = 0; i < bodies.size()-1; ++i) {
-      for (size_t j = i+1; j < bodies.size(); ++j) {
-        gravity_field.apply_force(bodies[i], bodies[j]);
-        electric_field.apply_force(bodies[i], bodies[j]);
-      }
+    const bool sample = diagnostics.wants_sample(sim.get_step_count());
+    if (sample) sim.measure_next_step();
+    sim.step(dt);
+    if (sample) {
+      diagnostics.record(sim.get_diagnostics());
+      diagnostics_text.setString(diagnostics.summary());
     }
 
-    // Euler step
-    for (auto& body : bodies) {
-      body.step(dt);
-    }
-
-    // Overlap passes
-    for (size_t o = 0; o < 2; ++o) {
-      eliminate_crossover(bodies, static_cast<bool>(o % 2));
-    }
-    // Process collisions
-    process_elastic_coll(bodies, dt);
-
     // Draw
     window.clear(sf::Color::Black);
 
-    for (auto& body : bodies) {
-      body.draw(window, body_shape);
-      if (renderAcc) {
-        body.render_acc(window);
-      }
-      body.reset_forces();
-    }
+    overlay.draw(window, sim);
+
+    renderer.draw(window, sim.get_bodies(), renderAcc);
 
     // Draw mouse drag
     if (dragging) window.draw(drag_line, 2, sf::PrimitiveType::Lines);
@@ -332,6 +199,7 @@ int main() {
     // Draw FPS counter
     fps_text.setString(std::to_string(1.0/dt));
     window.draw(fps_text);
+    window.draw(diagnostics_text);
     // ------------------------------------
     window.setView(main_camera);
 
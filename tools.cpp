@@ -1,4 +1,5 @@
 #include "tools.h"
+#include <algorithm>
 #include <cmath>
 
 #include "common.h"
@@ -26,4 +27,48 @@ namespace tools {
     return magnitude * Vector2f(std::cos(angle), std::sin(angle));
   }
 
+  void fft(std::vector<std::complex<float>>& data, const bool inverse) {
+    const size_t n = data.size();
+
+    // Bit reversal permutation
+    for (size_t i = 1, j = 0; i < n; ++i) {
+      size_t bit = n >> 1;
+      for (; j & bit; bit >>= 1) j ^= bit;
+      j ^= bit;
+      if (i < j) std::swap(data[i], data[j]);
+    }
+
+    // Butterflies
+    for (size_t len = 2; len <= n; len <<= 1) {
+      const double angle = 2.0 * M_PI / static_cast<double>(len) * (inverse ? 1.0 : -1.0);
+      const std::complex<float> w_len(std::cos(angle), std::sin(angle));
+      for (size_t i = 0; i < n; i += len) {
+        std::complex<float> w(1.0, 0.0);
+        for (size_t k = 0; k < len/2; ++k) {
+          const std::complex<float> u = data[i + k];
+          const std::complex<float> v = data[i + k + len/2] * w;
+          data[i + k] = u + v;
+          data[i + k + len/2] = u - v;
+          w *= w_len;
+        }
+      }
+    }
+  }
+
+  void fft_2d(std::vector<std::complex<float>>& data, const size_t nx, const size_t ny, const bool inverse) {
+    std::vector<std::complex<float>> line(nx);
+    for (size_t y = 0; y < ny; ++y) {
+      std::copy(data.begin() + y*nx, data.begin() + (y+1)*nx, line.begin());
+      fft(line, inverse);
+      std::copy(line.begin(), line.end(), data.begin() + y*nx);
+    }
+
+    line.resize(ny);
+    for (size_t x = 0; x < nx; ++x) {
+      for (size_t y = 0; y < ny; ++y) line[y] = data[y*nx + x];
+      fft(line, inverse);
+      for (size_t y = 0; y < ny; ++y) data[y*nx + x] = line[y];
+    }
+  }
+
 }  // namespace tools
\ No newline at end of file
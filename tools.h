@@ -1,5 +1,8 @@
 #pragma once
 
+#include <complex>
+#include <vector>
+
 #include <Eigen/Dense>
 using Eigen::Vector2f;
 
@@ -12,4 +15,9 @@ namespace tools {
   float circular_orbit_speed(const float host_mass, const float radius);
 
   Vector2f get_components(const float magnitude, const float angle);
+
+  // In place radix-2 FFT, size must be a power of 2. The inverse is not normalised (no 1/n).
+  void fft(std::vector<std::complex<float>>& data, const bool inverse);
+  // Row-major nx * ny grid, both powers of 2
+  void fft_2d(std::vector<std::complex<float>>& data, const size_t nx, const size_t ny, const bool inverse);
 }  // namespace tools
\ No newline at end of file